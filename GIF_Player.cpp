@@ -1,6 +1,30 @@
 #include <gtk/gtk.h>
 #include <gdk-pixbuf/gdk-pixbuf.h>
+#include <cairo.h>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cerrno>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <glib-unix.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 // ---------------- CONFIG ----------------
 // Screen resolution
@@ -13,24 +37,1404 @@ const int RIGHT_MARGIN  = 30;
 
 // Appearance
 const double OPACITY = 0.85; // 0.0 = fully transparent, 1.0 = solid
+const int CORNER_RADIUS = 0;  // Rounded corners in px, 0 = square; baked into frames at decode time
+
+// How OPACITY is applied: multiplied into the decoded frames once, handed to
+// the compositor as window opacity, or blended by cairo on every frame
+enum OpacityMode { OPACITY_BAKED, OPACITY_COMPOSITOR, OPACITY_PER_FRAME };
+const OpacityMode OPACITY_MODE = OPACITY_BAKED;
+
+// Frame delays of 10 ms or less are shown for 100 ms, as browsers do
+const int MIN_FRAME_DELAY_MS = 20;
+const int CLAMPED_FRAME_DELAY_MS = 100;
+
+// Where decoded frames live: every frame as a ready-to-blit surface; every
+// frame as one byte per pixel plus its palette, expanded into a scratch
+// surface when shown (a quarter of the memory, but frames with more than 256
+// colors are kept whole); or streamed from the file through a small ring of
+// surfaces that a worker thread decodes ahead. STORAGE_AUTO picks the first
+// of those that fits in FRAME_CACHE_LIMIT_MB, and streams GIFs whose indexed
+// frames turn out not to fit after all.
+enum FrameStorage { STORAGE_AUTO, STORAGE_CACHED, STORAGE_INDEXED, STORAGE_STREAMED };
+const FrameStorage FRAME_STORAGE = STORAGE_AUTO;
+const size_t FRAME_CACHE_LIMIT_MB = 128;
+const int STREAM_RING_FRAMES = 4;  // Surfaces in the streaming ring, including the one on screen
+
+// Finished frames of cached GIFs are saved under $XDG_CACHE_HOME/gif_player
+// and mmapped on the next start instead of being decoded again
+const bool DISK_CACHE = true;
+const size_t DISK_CACHE_LIMIT_MB = 512;   // Largest cache file written
+const size_t DISK_CACHE_TOTAL_MB = 1024;  // Whole directory; least recently used files go first
+
+// Instances showing the same GIF with the same settings share one read-only
+// copy of the frames when they are not already sharing the disk cache: the
+// first publishes a sealed memfd, later ones attach to it
+const bool SHARE_FRAMES = true;
 // --------------------------------------
 
-class GifPlayer {
+// ---------------- MAPPED FILE ----------------
+// Read-only view of a whole file; pages are read in as they are touched
+struct MappedFile {
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    bool open(const char *path) {
+        close();
+        int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return false;
+        map(fd);
+        ::close(fd);
+        return data != nullptr;
+    }
+
+    // The mapping outlives fd, which stays the caller's to close
+    bool map(int fd) {
+        close();
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping != MAP_FAILED) {
+                data = static_cast<const uint8_t*>(mapping);
+                size = st.st_size;
+            }
+        }
+        return data != nullptr;
+    }
+
+    void close() {
+        if (data) munmap(const_cast<uint8_t*>(data), size);
+        data = nullptr;
+        size = 0;
+    }
+};
+
+// ---------------- GIF STRUCTURE ----------------
+// Walks the GIF block structure without decoding any pixels: frame count,
+// each frame's rectangle, delay and disposal, and the NETSCAPE loop count.
+struct GifFrameInfo {
+    int x = 0, y = 0, width = 0, height = 0;
+    int delay_ms = 0;            // As stored in the file
+    int disposal = 0;            // 0/1 keep, 2 restore to background, 3 restore previous
+    int transparent_index = -1;  // -1 when the frame has no transparent color
+    size_t offset = 0;           // Image descriptor, just past its 0x2C introducer
+};
+
+struct GifInfo {
+    int width = 0;
+    int height = 0;
+    int loop_count = 0;  // 0 = forever
+    size_t palette_offset = 0;  // Global color table, when palette_size > 0
+    int palette_size = 0;
+    std::vector<GifFrameInfo> frames;
+
+    // Only frames whose data is complete are listed, so decoding them never
+    // reads past size
+    bool scan(const uint8_t *data, size_t size) {
+        if (size < 13 || memcmp(data, "GIF8", 4) != 0) return false;
+
+        width = data[6] | data[7] << 8;
+        height = data[8] | data[9] << 8;
+        size_t pos = 13;
+        if (data[10] & 0x80) {
+            palette_offset = pos;
+            palette_size = 2 << (data[10] & 0x07);
+            pos += 3 * palette_size;
+            if (pos > size) return false;
+        }
+
+        GifFrameInfo pending;  // Graphic control values for the next image
+        while (pos < size) {
+            uint8_t block = data[pos++];
+            if (block == 0x3B) break;  // Trailer
+
+            if (block == 0x21) {
+                if (pos + 1 >= size) break;
+                uint8_t label = data[pos++];
+                if (label == 0xF9 && pos + 5 <= size && data[pos] == 4) {
+                    uint8_t flags = data[pos + 1];
+                    pending.disposal = (flags >> 2) & 0x07;
+                    pending.delay_ms = (data[pos + 2] | data[pos + 3] << 8) * 10;
+                    pending.transparent_index = (flags & 0x01) ? data[pos + 4] : -1;
+                } else if (label == 0xFF && pos + 12 <= size && data[pos] == 11 &&
+                           memcmp(&data[pos + 1], "NETSCAPE2.0", 11) == 0) {
+                    size_t sub = pos + 12;
+                    if (sub + 4 <= size && data[sub] >= 3 && data[sub + 1] == 1) {
+                        loop_count = data[sub + 2] | data[sub + 3] << 8;
+                    }
+                }
+                if (!skip_sub_blocks(data, size, pos)) break;
+            } else if (block == 0x2C) {
+                if (pos + 9 > size) break;
+                GifFrameInfo frame = pending;
+                frame.offset = pos;
+                frame.x = data[pos] | data[pos + 1] << 8;
+                frame.y = data[pos + 2] | data[pos + 3] << 8;
+                frame.width = data[pos + 4] | data[pos + 5] << 8;
+                frame.height = data[pos + 6] | data[pos + 7] << 8;
+                uint8_t flags = data[pos + 8];
+                pos += 9;
+                if (flags & 0x80) pos += 3 << ((flags & 0x07) + 1);  // Local color table
+                pos++;  // LZW minimum code size
+                if (pos > size || !skip_sub_blocks(data, size, pos)) break;
+                frames.push_back(frame);
+                pending = GifFrameInfo();
+            } else {
+                break;  // Not a GIF block: stop at what decoded so far
+            }
+        }
+        return !frames.empty();
+    }
+
+private:
+    static bool skip_sub_blocks(const uint8_t *data, size_t size, size_t &pos) {
+        while (pos < size) {
+            uint8_t len = data[pos++];
+            if (len == 0) return true;
+            pos += len;
+        }
+        return false;
+    }
+};
+
+// ---------------- DAMAGE ----------------
+static GdkRectangle union_rect(const GdkRectangle &a, const GdkRectangle &b) {
+    if (a.width <= 0 || a.height <= 0) return b;
+    if (b.width <= 0 || b.height <= 0) return a;
+    int x1 = std::min(a.x, b.x);
+    int y1 = std::min(a.y, b.y);
+    int x2 = std::max(a.x + a.width, b.x + b.width);
+    int y2 = std::max(a.y + a.height, b.y + b.height);
+    return {x1, y1, x2 - x1, y2 - y1};
+}
+
+static GdkRectangle intersect_rect(const GdkRectangle &a, const GdkRectangle &b) {
+    int x1 = std::max(a.x, b.x);
+    int y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.width, b.x + b.width);
+    int y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) return {0, 0, 0, 0};
+    return {x1, y1, x2 - x1, y2 - y1};
+}
+
+// ---------------- GIF DECODER ----------------
+// Palette indices to pixels, 8 per step on AVX2; the transparent index (-1
+// for none) keeps what dst already had
+static void expand_indices(const uint8_t *src, uint32_t *dst, int count, const uint32_t *palette, int transparent) {
+    int x = 0;
+#ifdef __AVX2__
+    const __m256i key = _mm256_set1_epi32(transparent);
+    for (; x + 8 <= count; x += 8) {
+        __m256i index = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + x)));
+        __m256i color = _mm256_i32gather_epi32(reinterpret_cast<const int*>(palette), index, 4);
+        if (transparent >= 0) {
+            __m256i keep = _mm256_cmpeq_epi32(index, key);
+            __m256i old = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + x));
+            color = _mm256_blendv_epi8(color, old, keep);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + x), color);
+    }
+#endif
+    if (transparent < 0) {
+        for (; x < count; x++) dst[x] = palette[src[x]];
+        return;
+    }
+    for (; x < count; x++) {
+        if (src[x] != transparent) dst[x] = palette[src[x]];
+    }
+}
+
+// Decodes the frames of a scanned GIF in order, straight from the file bytes,
+// compositing each onto one canvas of premultiplied ARGB32. Memory is the
+// canvas plus one frame's palette indices, whatever the number of frames.
+// LZW strings are copied from where they were first written rather than
+// rebuilt code by code.
+class GifDecoder {
 public:
-    GifPlayer(const char* gif_path, int top_margin = TOP_MARGIN, int right_margin = RIGHT_MARGIN) {
-        gtk_init(nullptr, nullptr);
+    void reset(const uint8_t *file_data, size_t file_size, const GifInfo &gif) {
+        data = file_data;
+        size = file_size;
+        info = &gif;
+        canvas.assign((size_t)gif.width * gif.height, 0);
+        next_index = 0;
+    }
+
+    size_t next() const { return next_index; }
+
+    // Composite the next frame and copy the canvas to out; after the last
+    // frame, playback starts over from a cleared canvas
+    void decode_next(unsigned char *out, int out_stride) {
+        const std::vector<GifFrameInfo> &frames = info->frames;
+        if (next_index == 0) {
+            std::fill(canvas.begin(), canvas.end(), 0);
+        } else {
+            dispose(frames[next_index - 1]);
+        }
+
+        const GifFrameInfo &frame = frames[next_index];
+        if (frame.disposal == 3) save(frame);
+        draw(frame);
+
+        for (int y = 0; y < info->height; y++) {
+            memcpy(out + y * out_stride, &canvas[(size_t)y * info->width], info->width * 4);
+        }
+        next_index = (next_index + 1) % frames.size();
+    }
+
+private:
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    const GifInfo *info = nullptr;
+    size_t next_index = 0;
+    std::vector<uint32_t> canvas;
+    std::vector<uint32_t> saved;  // Area under a "restore previous" frame
+    std::vector<uint8_t> indices;
+    std::vector<uint8_t> compressed;  // The frame's LZW sub-blocks, joined
+
+    // LZW string table: every code's string already sits in the output, at
+    // position with this length
+    uint32_t position[4096];
+    uint16_t length[4096];
+
+    GdkRectangle clipped(const GifFrameInfo &frame) const {
+        return intersect_rect({frame.x, frame.y, frame.width, frame.height}, {0, 0, info->width, info->height});
+    }
+
+    void save(const GifFrameInfo &frame) {
+        GdkRectangle r = clipped(frame);
+        saved.resize((size_t)r.width * r.height);
+        for (int y = 0; y < r.height; y++) {
+            memcpy(&saved[(size_t)y * r.width], &canvas[(size_t)(r.y + y) * info->width + r.x], r.width * 4);
+        }
+    }
+
+    void dispose(const GifFrameInfo &frame) {
+        if (frame.disposal != 2 && frame.disposal != 3) return;
+        GdkRectangle r = clipped(frame);
+        for (int y = 0; y < r.height; y++) {
+            uint32_t *row = &canvas[(size_t)(r.y + y) * info->width + r.x];
+            if (frame.disposal == 2) {
+                std::fill(row, row + r.width, 0);  // Background is transparent, as in browsers
+            } else {
+                memcpy(row, &saved[(size_t)y * r.width], r.width * 4);
+            }
+        }
+    }
+
+    void draw(const GifFrameInfo &frame) {
+        if (frame.x >= info->width || frame.y >= info->height) return;
+        const uint8_t *descriptor = data + frame.offset;
+        uint8_t flags = descriptor[8];
+        const uint8_t *colors = data + info->palette_offset;
+        int color_count = info->palette_size;
+        const uint8_t *lzw = descriptor + 9;
+        if (flags & 0x80) {
+            colors = lzw;
+            color_count = 2 << (flags & 0x07);
+            lzw += 3 * color_count;
+        }
+
+        // Opaque colors are already premultiplied; indices past the table are black
+        uint32_t palette[256];
+        for (int i = 0; i < 256; i++) {
+            const uint8_t *c = colors + 3 * i;
+            palette[i] = i < color_count ? 0xFF000000u | c[0] << 16 | c[1] << 8 | c[2] : 0xFF000000u;
+        }
+
+        // Only rows that land on the canvas are decoded. Interlaced rows come
+        // in pass order, so those frames need every row; a frame that would
+        // need more indices than the canvas or 4x its visible part has pixels
+        // is mostly off the canvas and is skipped rather than buffered.
+        bool interlaced = flags & 0x40;
+        int visible_rows = std::min(frame.height, info->height - frame.y);
+        int visible_columns = std::min(frame.width, info->width - frame.x);
+        size_t pixels = (size_t)frame.width * (interlaced ? frame.height : visible_rows);
+        if (pixels > std::max(canvas.size(), (size_t)visible_columns * visible_rows * 4)) return;
+        indices.resize(pixels + 16);  // Slack for copy_string's overshoot
+        size_t decoded = decode_lzw(lzw, indices.data(), pixels);
+
+        for (int row = 0; row < frame.height && (size_t)row * frame.width < decoded; row++) {
+            int y = frame.y + (interlaced ? interlaced_row(row, frame.height) : row);
+            if (y >= info->height) continue;
+            const uint8_t *src = &indices[(size_t)row * frame.width];
+            int count = (int)std::min<size_t>(frame.width, decoded - (size_t)row * frame.width);
+            count = std::min(count, info->width - frame.x);
+            expand_indices(src, &canvas[(size_t)y * info->width + frame.x], count, palette, frame.transparent_index);
+        }
+    }
+
+    // Interlaced rows come in four passes: every 8th from 0, every 8th from 4,
+    // every 4th from 2, every 2nd from 1
+    static int interlaced_row(int row, int height) {
+        int pass1 = (height + 7) / 8;
+        if (row < pass1) return row * 8;
+        row -= pass1;
+        int pass2 = (height + 3) / 8;
+        if (row < pass2) return 4 + row * 8;
+        row -= pass2;
+        int pass3 = (height + 1) / 4;
+        if (row < pass3) return 2 + row * 4;
+        return 1 + (row - pass3) * 2;
+    }
+
+    // Returns how many indices were written; corrupt or short data just ends
+    // the frame early, leaving the rest of the canvas as it was. out needs 16
+    // bytes of slack past out_size.
+    size_t decode_lzw(const uint8_t *p, uint8_t *out, size_t out_size) {
+        const uint8_t *end = data + size;
+        if (p >= end) return 0;
+        int min_code_size = *p++;
+        if (min_code_size < 1 || min_code_size > 11) return 0;
+
+        // Join the sub-blocks so codes never straddle a length byte
+        compressed.clear();
+        while (p < end && *p != 0) {
+            size_t len = std::min<size_t>(*p, end - p - 1);
+            compressed.insert(compressed.end(), p + 1, p + 1 + len);
+            p += 1 + len;
+        }
+        size_t bit_end = compressed.size() * 8;
+        compressed.resize(compressed.size() + 4, 0);  // The reader loads 3 bytes at a time
+        const uint8_t *in = compressed.data();
+
+        int clear = 1 << min_code_size;
+        int code_size = min_code_size + 1;
+        int next_code = clear + 2;
+        size_t prev_pos = 0;
+        size_t prev_len = 0;  // 0: no previous code since the last clear
+        size_t bit_pos = 0;
+        size_t written = 0;
+
+        while (written < out_size && bit_pos + code_size <= bit_end) {
+            const uint8_t *b = in + (bit_pos >> 3);
+            uint32_t window = b[0] | b[1] << 8 | b[2] << 16;
+            int code = (window >> (bit_pos & 7)) & ((1 << code_size) - 1);
+            bit_pos += code_size;
+
+            if (code == clear) {
+                code_size = min_code_size + 1;
+                next_code = clear + 2;
+                prev_len = 0;
+                continue;
+            }
+            if (code == clear + 1) break;  // End of information
+
+            size_t len;
+            size_t room = out_size - written;
+            if (code < clear) {
+                out[written] = code;
+                len = 1;
+            } else if (prev_len == 0 || code > next_code) {
+                break;  // Not in the table: corrupt data
+            } else if (code < next_code) {
+                len = length[code];
+                copy_string(out + written, out + position[code], std::min<size_t>(len, room));
+            } else {
+                // The one code not in the table yet: the previous string plus its first byte
+                len = prev_len + 1;
+                copy_string(out + written, out + prev_pos, std::min(prev_len, room));
+                if (room > prev_len) out[written + prev_len] = out[prev_pos];
+            }
+
+            // The new string is the previous one plus this one's first byte,
+            // which the output already holds back to back
+            if (prev_len > 0 && next_code < 4096) {
+                position[next_code] = prev_pos;
+                length[next_code] = prev_len + 1;
+                next_code++;
+                if (next_code == 1 << code_size && code_size < 12) code_size++;
+            }
+            prev_pos = written;
+            prev_len = len;
+            written += std::min(len, room);
+        }
+        return written;
+    }
+
+    // A string's source always ends before its destination starts, so
+    // copying in 8-byte chunks is safe; it may write up to 7 bytes past len
+    static void copy_string(uint8_t *dst, const uint8_t *src, size_t len) {
+        for (size_t i = 0; i < len; i += 8) {
+            uint64_t chunk;
+            memcpy(&chunk, src + i, 8);
+            memcpy(dst + i, &chunk, 8);
+        }
+    }
+};
+
+// ---------------- FRAME CACHE ----------------
+// Every GIF frame decoded once by GifDecoder into a premultiplied ARGB32
+// surface, so playback is a plain blit. With DISK_CACHE or SHARE_FRAMES those
+// surfaces are views of a mapped frame store (a cache file, or a memfd another
+// instance published) that pages in as frames are shown. Indexed frames keep a byte per pixel
+// and are expanded into one scratch surface, only where they changed.
+// Streamed GIFs keep only the mapped file and STREAM_RING_FRAMES surfaces,
+// which a worker thread fills a few frames ahead of playback. Other formats
+// gdk-pixbuf reads are stills.
+class FrameCache {
+#ifdef GWS_BENCH
+    friend void run_decode_bench(const char* gif_path, int passes);
+#endif
+public:
+    ~FrameCache() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(ring_mutex);
+                stopping = true;
+            }
+            ring_changed.notify_all();
+            worker.join();
+        }
+        for (auto surface : surfaces) cairo_surface_destroy(surface);
+        if (share_watch) g_source_remove(share_watch);
+        if (share_listener >= 0) ::close(share_listener);
+        if (share_server >= 0) ::close(share_server);
+        // Hanging up on our clients lets one of them take over the name, now free
+        for (auto &client : share_clients) {
+            g_source_remove(client.second);
+            ::close(client.first);
+        }
+        if (share_fd >= 0) ::close(share_fd);
+    }
+
+    // baked_opacity (1.0 = none) is multiplied into every frame at decode time
+    bool load(const char *path, double baked_opacity, FrameStorage storage, std::string &error) {
+        opacity_alpha = (uint32_t)lround(std::clamp(baked_opacity, 0.0, 1.0) * 255);
+
+        if (file.open(path) && info.scan(file.data, file.size) && info.width > 0 && info.height > 0) {
+            if (info.width > MAX_SURFACE_SIDE || info.height > MAX_SURFACE_SIDE) {
+                error = "GIF is " + std::to_string(info.width) + "x" + std::to_string(info.height) +
+                        ", larger than cairo can draw";
+                return false;
+            }
+            width = info.width;
+            height = info.height;
+            loop_count = info.loop_count;
+            for (const GifFrameInfo &frame : info.frames) delays.push_back(frame.delay_ms);
+            compute_descriptor_damage(info);
+            build_corner_mask();
+
+            size_t stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, width);
+            size_t limit = FRAME_CACHE_LIMIT_MB * 1024 * 1024;
+            mode = size() == 1 ? STORAGE_CACHED : storage;
+            if (mode == STORAGE_AUTO) {
+                mode = stride * height * size() <= limit          ? STORAGE_CACHED
+                     : (size_t)width * height * size() <= limit   ? STORAGE_INDEXED
+                                                                  : STORAGE_STREAMED;
+            }
+            if (mode == STORAGE_STREAMED) {
+                if (!start_stream()) {
+                    error = "Out of memory for the frame ring";
+                    return false;
+                }
+                return true;
+            }
+
+            // Decode everything now; the file is not needed afterwards
+            std::string key = mode == STORAGE_CACHED ? prepare_frame_store(path, stride) : "";
+            if (!key.empty() && attach_frame_store(key)) {
+                file.close();
+                return true;
+            }
+            decoder.reset(file.data, file.size, info);
+            if (mode == STORAGE_INDEXED) {
+                if (!decode_indexed(storage == STORAGE_AUTO ? limit : SIZE_MAX)) {
+                    indexed.clear();
+                    mode = STORAGE_STREAMED;
+                    if (!start_stream()) {
+                        error = "Out of memory for the frame ring";
+                        return false;
+                    }
+                    return true;
+                }
+                if (!surfaces[0]) {
+                    error = "Out of memory for the frames";
+                    return false;
+                }
+            } else {
+                for (size_t i = 0; i < size(); i++) {
+                    cairo_surface_t *surface = frame_surface(width, height);
+                    if (!surface) {
+                        error = "Out of memory for the frames";
+                        return false;
+                    }
+                    decoder.decode_next(cairo_image_surface_get_data(surface), stride);
+                    cairo_surface_mark_dirty(surface);
+                    surfaces.push_back(surface);
+                }
+                for (size_t i = 0; i < size() && size() > 1; i++) {
+                    tighten_damage(i, cairo_image_surface_get_data(surfaces[(i + size() - 1) % size()]),
+                                   cairo_image_surface_get_data(surfaces[i]), stride);
+                }
+                for (auto surface : surfaces) finish_frame(surface);
+                if (!key.empty()) publish_frame_store(key);
+            }
+            file.close();
+            return true;
+        }
+        file.close();
+
+        // Anything else gdk-pixbuf can open is shown as a still image
+        GError *gerror = nullptr;
+        GdkPixbuf *pixbuf = gdk_pixbuf_new_from_file(path, &gerror);
+        if (!pixbuf) {
+            error = gerror->message;
+            g_error_free(gerror);
+            return false;
+        }
+        width = gdk_pixbuf_get_width(pixbuf);
+        height = gdk_pixbuf_get_height(pixbuf);
+        delays.push_back(0);
+        damages.assign(1, GdkRectangle{0, 0, width, height});
+        build_corner_mask();
+
+        cairo_surface_t *surface = frame_surface(width, height);
+        if (!surface) {
+            error = "Image is " + std::to_string(width) + "x" + std::to_string(height) + ", too large to draw";
+            g_object_unref(pixbuf);
+            return false;
+        }
+        to_premultiplied(pixbuf, surface);
+        finish_frame(surface);
+        surfaces.push_back(surface);
+        g_object_unref(pixbuf);
+        return true;
+    }
+
+    size_t size() const { return delays.size(); }
+    int frame_width() const { return width; }
+    int frame_height() const { return height; }
+    int delay(size_t index) const { return delays[index]; }  // As stored in the file
+    int loops() const { return loop_count; }
+
+    // Area that differs between the previous frame (the last one, for frame 0)
+    // and frame index; empty when the two frames are identical
+    const GdkRectangle &damage(size_t index) const { return damages[index]; }
+    FrameStorage storage() const { return mode; }
+    // Indexed frames with too many colors for a palette, stored at 4 bytes a pixel
+    size_t full_color_frames() const {
+        return std::count_if(indexed.begin(), indexed.end(), [](const IndexedFrame &frame) { return !frame.argb.empty(); });
+    }
+    // Where the frames came from when this instance did not decode them
+    enum StoreSource { STORE_DECODED, STORE_DISK_CACHE, STORE_SHARED };
+    StoreSource store_source() const { return source; }
+
+    // Ready-to-blit surface for frame index. Indexed and streamed frames must
+    // be asked for in playback order and stay valid until a different index is.
+    cairo_surface_t *surface(size_t index) {
+        if (mode == STORAGE_CACHED) return surfaces[index];
+        if (mode == STORAGE_INDEXED) {
+            if (index != shown_index) expand_frame(index);
+            return surfaces[0];
+        }
+        if (shown_slot >= 0 && index == shown_index) return surfaces[shown_slot];
+
+        std::unique_lock<std::mutex> lock(ring_mutex);
+        if (shown_slot >= 0) free_slots.push_back(shown_slot);
+        // Frames playback skipped were decoded anyway: each one builds on the last
+        for (;;) {
+            ring_changed.notify_all();  // Slots were just freed
+            ring_changed.wait(lock, [this] { return !ready.empty(); });
+            auto [frame, slot] = ready.front();
+            ready.pop_front();
+            if (frame == index) {
+                shown_slot = slot;
+                shown_index = index;
+                break;
+            }
+            free_slots.push_back(slot);
+        }
+        lock.unlock();
+        ring_changed.notify_all();
+        cairo_surface_mark_dirty(surfaces[shown_slot]);
+        return surfaces[shown_slot];
+    }
+
+private:
+    int width = 0;
+    int height = 0;
+    int loop_count = 0;
+    static const int MAX_SURFACE_SIDE = 32767;  // cairo's image surface limit
+
+    MappedFile file;
+    GifInfo info;
+    GifDecoder decoder;
+    FrameStorage mode = STORAGE_CACHED;
+    std::vector<cairo_surface_t*> surfaces;  // Every frame, the indexed scratch, or the streaming ring
+    std::vector<int> delays;
+    std::vector<GdkRectangle> damages;
+
+    // Antialiased coverage of one rounded corner: a 2r x 2r disc whose four
+    // quadrants are the four corners
+    std::vector<uint8_t> corner_mask;
+    int corner_radius = 0;
+    uint32_t opacity_alpha = 255;
+
+    // Frame on screen: the indexed scratch's contents, or the streaming slot's
+    size_t shown_index = SIZE_MAX;
+
+    // Frame store layout, for the disk cache file and the shared memfd alike:
+    // this header, int32 delays, GdkRectangle damage rectangles, then from
+    // frames_offset every frame's finished pixels. A store is used only if
+    // its header matches the expected one exactly.
+    struct FrameStoreHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t source_hash;      // Contents of the GIF
+        uint64_t source_size;
+        int64_t source_mtime_ns;
+        uint64_t path_hash;        // Which GIF it was, to drop stale cache files
+        int32_t width, height, stride;
+        uint32_t frame_count;
+        int32_t loop_count;
+        uint32_t opacity_alpha;    // Finishing baked into the frames
+        int32_t corner_radius;
+        uint32_t reserved;
+        uint64_t frames_offset;    // Page-aligned
+    };
+    FrameStoreHeader store_header;
+    MappedFile frame_store;
+    StoreSource source = STORE_DECODED;
+
+    // Serving the shared store to other instances
+    int share_fd = -1;
+    std::string share_key;
+    int share_listener = -1;  // While we hold the name
+    int share_server = -1;    // Otherwise our connection to whoever does, which hangs up when they exit
+    guint share_watch = 0;    // Watches the listener or the server connection
+    std::vector<std::pair<int, guint>> share_clients;  // Instances we served, and their watches
+
+    // Indexed: at most 256 colors (opacity already applied) and a byte per
+    // pixel; frames with more colors keep their pixels whole
+    struct IndexedFrame {
+        std::vector<uint32_t> palette;
+        std::vector<uint8_t> pixels;
+        std::vector<uint32_t> argb;
+    };
+    std::vector<IndexedFrame> indexed;
+
+    // Streaming: ring slots cycle free -> decoded by the worker -> ready -> on screen -> free
+    std::thread worker;
+    std::mutex ring_mutex;
+    std::condition_variable ring_changed;
+    std::deque<std::pair<size_t, int>> ready;  // (frame index, slot), in decode order
+    std::vector<int> free_slots;
+    int shown_slot = -1;
+    bool stopping = false;
+
+    // Fills in the expected store header and returns its key, which names
+    // the cache file and the shared store; empty when neither is in use
+    std::string prepare_frame_store(const char *path, size_t stride) {
+        struct stat st;
+        if ((!DISK_CACHE && !SHARE_FRAMES) || size() < 2 || stat(path, &st) != 0) return "";
+        char *real = realpath(path, nullptr);
+        std::string source_path = real ? real : path;
+        free(real);
+
+        FrameStoreHeader &h = store_header;
+        memset(&h, 0, sizeof h);
+        memcpy(h.magic, "GWSGIFC", 8);
+        h.version = 1;
+        h.header_size = sizeof h;
+        h.source_hash = hash_bytes(file.data, file.size);
+        h.source_size = st.st_size;
+        h.source_mtime_ns = st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+        h.path_hash = hash_bytes(source_path.data(), source_path.size());
+        h.width = width;
+        h.height = height;
+        h.stride = (int32_t)stride;
+        h.frame_count = (uint32_t)size();
+        h.loop_count = loop_count;
+        h.opacity_alpha = opacity_alpha;
+        h.corner_radius = corner_radius;
+        h.frames_offset = (sizeof h + size() * (sizeof(int32_t) + sizeof(GdkRectangle)) + 4095) & ~(uint64_t)4095;
+
+        char key[17];
+        snprintf(key, sizeof key, "%016llx", (unsigned long long)hash_bytes(&h, sizeof h));
+        return key;
+    }
+
+    std::string disk_cache_path(const std::string &key) const {
+        return std::string(g_get_user_cache_dir()) + "/gif_player/" + key + ".frames";
+    }
+
+    bool fits_disk_cache() const {
+        size_t limit_mb = std::min(DISK_CACHE_LIMIT_MB, DISK_CACHE_TOTAL_MB);
+        return DISK_CACHE && store_header.frames_offset + store_bytes() <= limit_mb * 1024 * 1024;
+    }
+
+    size_t store_bytes() const {
+        return (size_t)store_header.stride * store_header.height * size();
+    }
+
+    // An existing store: the disk cache file, else another instance's memfd
+    bool attach_frame_store(const std::string &key) {
+        if (fits_disk_cache() && frame_store.open(disk_cache_path(key).c_str()) && use_frame_store()) {
+            // Mark it used for the sweep's eviction order; relatime would not
+            timespec times[2] = {{0, UTIME_NOW}, {0, UTIME_OMIT}};
+            utimensat(AT_FDCWD, disk_cache_path(key).c_str(), times, 0);
+            source = STORE_DISK_CACHE;
+            return true;
+        }
+        if (!SHARE_FRAMES) return false;
+        int server;
+        int fd = receive_shared_store(key, server);
+        if (fd < 0) return false;
+        if (!frame_store.map(fd) || !use_frame_store()) {
+            ::close(fd);
+            ::close(server);
+            return false;
+        }
+        source = STORE_SHARED;
+        serve_frame_store(fd, key, server);
+        return true;
+    }
+
+    // After decoding: write the disk cache, or publish a memfd for other
+    // instances. Either way the decoded surfaces are swapped for the store's
+    // clean, shared pages.
+    void publish_frame_store(const std::string &key) {
+        if (fits_disk_cache() && write_disk_cache(disk_cache_path(key))) {
+            if (frame_store.open(disk_cache_path(key).c_str())) use_frame_store();
+            return;
+        }
+        if (!SHARE_FRAMES) return;
+
+        int fd = memfd_create("gif_player frames", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+        if (fd < 0) return;
+        // Sealed against every change, so attached instances can trust it stays as validated
+        if (!write_frame_store(fd) ||
+            fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0 ||
+            !frame_store.map(fd) || !use_frame_store()) {
+            ::close(fd);
+            return;
+        }
+        serve_frame_store(fd, key, -1);
+    }
+
+    // Surfaces over the mapped store, replacing any decoded ones
+    bool use_frame_store() {
+        const FrameStoreHeader &h = store_header;
+        size_t frame_bytes = (size_t)h.stride * h.height;
+        if (frame_store.size < h.frames_offset + store_bytes() || memcmp(frame_store.data, &h, sizeof h) != 0) {
+            frame_store.close();
+            return false;
+        }
+
+        const uint8_t *tables = frame_store.data + sizeof h;
+        const int32_t *stored_delays = reinterpret_cast<const int32_t*>(tables);
+        const GdkRectangle *stored_damages = reinterpret_cast<const GdkRectangle*>(tables + size() * sizeof(int32_t));
+        delays.assign(stored_delays, stored_delays + size());
+        damages.assign(stored_damages, stored_damages + size());
+
+        for (auto surface : surfaces) cairo_surface_destroy(surface);
+        surfaces.clear();
+        for (size_t i = 0; i < size(); i++) {
+            // Read-only mapping: cairo only ever reads a surface used as a source
+            unsigned char *pixels = const_cast<uint8_t*>(frame_store.data + h.frames_offset + i * frame_bytes);
+            surfaces.push_back(cairo_image_surface_create_for_data(pixels, CAIRO_FORMAT_ARGB32, width, height, h.stride));
+        }
+        return true;
+    }
+
+    bool write_frame_store(int fd) {
+        const FrameStoreHeader &h = store_header;
+        std::vector<uint8_t> tables(h.frames_offset, 0);
+        memcpy(tables.data(), &h, sizeof h);
+        for (size_t i = 0; i < size(); i++) {
+            int32_t delay = delays[i];
+            memcpy(&tables[sizeof h + i * sizeof delay], &delay, sizeof delay);
+        }
+        memcpy(&tables[sizeof h + size() * sizeof(int32_t)], damages.data(), size() * sizeof(GdkRectangle));
+        if (!write_all(fd, tables.data(), tables.size())) return false;
+
+        for (auto surface : surfaces) {
+            cairo_surface_flush(surface);
+            if (!write_all(fd, cairo_image_surface_get_data(surface), (size_t)h.stride * height)) return false;
+        }
+        return true;
+    }
+
+    static bool write_all(int fd, const void *bytes, size_t count) {
+        const uint8_t *p = static_cast<const uint8_t*>(bytes);
+        while (count > 0) {
+            ssize_t written = write(fd, p, count);
+            if (written < 0 && errno == EINTR) continue;
+            if (written <= 0) return false;
+            p += written;
+            count -= written;
+        }
+        return true;
+    }
+
+    // Written under a temporary name and renamed, so other instances only
+    // ever see a complete file
+    bool write_disk_cache(const std::string &cache_path) {
+        std::string dir = cache_path.substr(0, cache_path.rfind('/'));
+        if (g_mkdir_with_parents(dir.c_str(), 0700) != 0) return false;
+        sweep_disk_cache(cache_path, store_header.frames_offset + store_bytes());
+
+        std::string temp_path = cache_path + ".tmp" + std::to_string(getpid());
+        int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+        if (fd < 0) return false;
+        bool written = write_frame_store(fd);
+        if (::close(fd) != 0 || !written || rename(temp_path.c_str(), cache_path.c_str()) != 0) {
+            unlink(temp_path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Makes room for incoming bytes at cache_path: drops temporaries of
+    // writers that died, caches of this GIF from before it was edited, then
+    // the least recently used caches until all fits in DISK_CACHE_TOTAL_MB.
+    // Caches of the same GIF with other finishing are kept while they fit.
+    void sweep_disk_cache(const std::string &cache_path, uint64_t incoming) {
+        std::string dir = cache_path.substr(0, cache_path.rfind('/'));
+        DIR *listing = opendir(dir.c_str());
+        if (!listing) return;
+
+        struct CacheFile { std::string path; uint64_t bytes; int64_t used_ns; };
+        std::vector<CacheFile> kept;
+        uint64_t total = incoming;
+        const FrameStoreHeader &h = store_header;
+        while (struct dirent *entry = readdir(listing)) {
+            std::string name = entry->d_name;
+            std::string entry_path = dir + "/" + name;
+            size_t temp = name.rfind(".frames.tmp");
+            if (temp != std::string::npos) {
+                pid_t writer = atoi(name.c_str() + temp + 11);
+                if (writer <= 0 || (kill(writer, 0) != 0 && errno == ESRCH)) unlink(entry_path.c_str());
+                continue;
+            }
+            if (name.size() < 7 || name.compare(name.size() - 7, 7, ".frames") != 0 || entry_path == cache_path) continue;
+
+            int fd = ::open(entry_path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            FrameStoreHeader other;
+            struct stat st;
+            bool stale = pread(fd, &other, sizeof other, 0) == (ssize_t)sizeof other &&
+                         memcmp(other.magic, "GWSGIFC", 8) == 0 && other.path_hash == h.path_hash &&
+                         (other.source_hash != h.source_hash || other.source_size != h.source_size ||
+                          other.source_mtime_ns != h.source_mtime_ns);
+            bool listed = fstat(fd, &st) == 0;
+            ::close(fd);
+            if (stale) {
+                unlink(entry_path.c_str());
+            } else if (listed) {
+                int64_t used_ns = std::max(st.st_atim.tv_sec * 1000000000LL + st.st_atim.tv_nsec,
+                                           st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec);
+                kept.push_back({entry_path, (uint64_t)st.st_size, used_ns});
+                total += st.st_size;
+            }
+        }
+        closedir(listing);
+
+        // Unlinking a cache another instance has mapped is safe: its mapping stays
+        std::sort(kept.begin(), kept.end(), [](const CacheFile &a, const CacheFile &b) { return a.used_ns < b.used_ns; });
+        for (const CacheFile &file : kept) {
+            if (total <= DISK_CACHE_TOTAL_MB * 1024 * 1024) break;
+            if (unlink(file.path.c_str()) == 0) total -= file.bytes;
+        }
+    }
+
+    // Abstract socket named after the key and our uid; nothing on disk to clean
+    // up, but any local user can connect, so both ends check the peer's uid
+    static socklen_t share_address(const std::string &key, sockaddr_un &address) {
+        memset(&address, 0, sizeof address);
+        address.sun_family = AF_UNIX;
+        int length = snprintf(address.sun_path + 1, sizeof address.sun_path - 1, "gif_player/%u/%s",
+                              (unsigned)getuid(), key.c_str());
+        return offsetof(sockaddr_un, sun_path) + 1 + length;
+    }
+
+    // Hands fd to instances started later. Attached instances serve too:
+    // while the name is taken (by server, the instance we got fd from, or
+    // whoever won a race for it) they keep a connection to its holder, and
+    // bid for the name when it hangs up, so sharing outlives the instance
+    // that decoded
+    void serve_frame_store(int fd, const std::string &key, int server) {
+        share_fd = fd;
+        share_key = key;
+        if (server >= 0) {
+            watch_share_server(server);
+        } else {
+            take_over_sharing();
+        }
+    }
+
+    void take_over_sharing() {
+        // Losing the name to an instance that has not called listen() yet
+        // refuses our connection too; a couple more tries get past that
+        for (int attempt = 0; attempt < 3; attempt++) {
+            if (listen_for_instances()) return;
+            int server;
+            int fd = receive_shared_store(share_key, server);
+            if (fd >= 0) {
+                ::close(fd);  // The same frames we hold
+                watch_share_server(server);
+                return;
+            }
+        }
+    }
+
+    bool listen_for_instances() {
+        sockaddr_un address;
+        socklen_t length = share_address(share_key, address);
+        int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+        if (listener < 0) return false;
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0 || listen(listener, 8) != 0) {
+            ::close(listener);
+            return false;
+        }
+        share_listener = listener;
+        share_watch = g_unix_fd_add(listener, G_IO_IN, on_instance_connected, this);
+        return true;
+    }
+
+    void watch_share_server(int server) {
+        share_server = server;
+        share_watch = g_unix_fd_add(server, G_IO_HUP, on_share_server_gone, this);
+    }
+
+    static gboolean on_share_server_gone(gint server, GIOCondition, gpointer data) {
+        auto *self = static_cast<FrameCache*>(data);
+        ::close(server);
+        self->share_server = -1;
+        self->share_watch = 0;
+        self->take_over_sharing();
+        return G_SOURCE_REMOVE;
+    }
+
+    static gboolean on_instance_connected(gint listener, GIOCondition, gpointer data) {
+        auto *self = static_cast<FrameCache*>(data);
+        int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) return G_SOURCE_CONTINUE;
+
+        // Other users' processes get nothing: the frames are ours
+        ucred peer;
+        socklen_t peer_length = sizeof peer;
+        if (getsockopt(client, SOL_SOCKET, SO_PEERCRED, &peer, &peer_length) == 0 && peer.uid == getuid()) {
+            char byte = 0;
+            iovec payload = {&byte, 1};
+            char control[CMSG_SPACE(sizeof(int))] = {};
+            msghdr message = {};
+            message.msg_iov = &payload;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof control;
+            cmsghdr *fd_message = CMSG_FIRSTHDR(&message);
+            fd_message->cmsg_level = SOL_SOCKET;
+            fd_message->cmsg_type = SCM_RIGHTS;
+            fd_message->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(fd_message), &self->share_fd, sizeof(int));
+            // Kept open until the client exits: our exit is its cue to take over
+            if (sendmsg(client, &message, MSG_NOSIGNAL) == 1) {
+                guint watch = g_unix_fd_add(client, G_IO_HUP, on_instance_gone, self);
+                self->share_clients.push_back({client, watch});
+                return G_SOURCE_CONTINUE;
+            }
+        }
+        ::close(client);
+        return G_SOURCE_CONTINUE;
+    }
+
+    static gboolean on_instance_gone(gint client, GIOCondition, gpointer data) {
+        auto *self = static_cast<FrameCache*>(data);
+        auto &clients = self->share_clients;
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [client](const std::pair<int, guint> &c) { return c.first == client; }),
+                      clients.end());
+        ::close(client);
+        return G_SOURCE_REMOVE;
+    }
+
+    // The published memfd, if an instance of our own user serves this key and
+    // has sealed it, with the connection it came over in server; -1 otherwise
+    static int receive_shared_store(const std::string &key, int &server) {
+        server = -1;
+        sockaddr_un address;
+        socklen_t length = share_address(key, address);
+        int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (sock < 0) return -1;
+
+        int fd = -1;
+        ucred peer;
+        socklen_t peer_length = sizeof peer;
+        timeval timeout = {1, 0};
+        if (connect(sock, reinterpret_cast<sockaddr*>(&address), length) == 0 &&
+            getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &peer, &peer_length) == 0 && peer.uid == getuid() &&
+            setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout) == 0) {
+            char byte;
+            iovec payload = {&byte, 1};
+            char control[CMSG_SPACE(sizeof(int))] = {};
+            msghdr message = {};
+            message.msg_iov = &payload;
+            message.msg_iovlen = 1;
+            message.msg_control = control;
+            message.msg_controllen = sizeof control;
+            if (recvmsg(sock, &message, MSG_CMSG_CLOEXEC) == 1) {
+                // Anything but a single fd, untruncated, is not from us; close what arrived
+                std::vector<int> received;
+                for (cmsghdr *c = CMSG_FIRSTHDR(&message); c; c = CMSG_NXTHDR(&message, c)) {
+                    if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+                    for (size_t i = 0; i < (c->cmsg_len - CMSG_LEN(0)) / sizeof(int); i++) {
+                        received.push_back(-1);
+                        memcpy(&received.back(), CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+                    }
+                }
+                if (received.size() == 1 && !(message.msg_flags & MSG_CTRUNC)) {
+                    fd = received[0];
+                } else {
+                    for (int unexpected : received) ::close(unexpected);
+                }
+            }
+        }
+
+        int required = F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+        if (fd >= 0 && (fcntl(fd, F_GET_SEALS) & required) != required) {
+            ::close(fd);
+            fd = -1;
+        }
+        if (fd >= 0) {
+            server = sock;
+        } else {
+            ::close(sock);
+        }
+        return fd;
+    }
+
+    // FNV-1a over 8-byte words, folded so high bits reach the low ones
+    static uint64_t hash_bytes(const void *bytes, size_t count) {
+        const uint8_t *p = static_cast<const uint8_t*>(bytes);
+        uint64_t hash = 14695981039346656037ull;
+        for (; count >= 8; p += 8, count -= 8) {
+            uint64_t word;
+            memcpy(&word, p, 8);
+            hash = (hash ^ word) * 1099511628211ull;
+            hash ^= hash >> 32;
+        }
+        for (; count > 0; p++, count--) hash = (hash ^ *p) * 1099511628211ull;
+        return hash;
+    }
+
+    // False, with some frames stored, once they take more than limit bytes
+    bool decode_indexed(size_t limit) {
+        std::vector<uint32_t> first, previous((size_t)width * height), current((size_t)width * height);
+        size_t stored = 0;
+        for (size_t i = 0; i < size(); i++) {
+            decoder.decode_next(reinterpret_cast<unsigned char*>(current.data()), width * 4);
+            store_indexed(current.data());
+            const IndexedFrame &frame = indexed.back();
+            stored += frame.palette.size() * 4 + frame.pixels.size() + frame.argb.size() * 4;
+            if (stored > limit) return false;
+            if (i == 0) {
+                first = current;
+            } else {
+                tighten_damage(i, reinterpret_cast<unsigned char*>(previous.data()),
+                               reinterpret_cast<unsigned char*>(current.data()), width * 4);
+            }
+            std::swap(previous, current);
+        }
+        tighten_damage(0, reinterpret_cast<unsigned char*>(previous.data()),
+                       reinterpret_cast<unsigned char*>(first.data()), width * 4);
+        surfaces.push_back(frame_surface(width, height));  // Scratch; load checks it
+        return true;
+    }
+
+    void store_indexed(const uint32_t *pixels) {
+        size_t count = (size_t)width * height;
+        IndexedFrame frame;
+        frame.pixels.resize(count);
+
+        // Open-addressed color -> index table; runs of one color skip the lookup
+        uint32_t keys[1024];
+        int16_t values[1024];
+        std::fill(values, values + 1024, -1);
+        uint32_t last_color = ~pixels[0];
+        uint8_t last_index = 0;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t color = pixels[i];
+            if (color != last_color) {
+                uint32_t slot = (color * 2654435761u) >> 22;
+                while (values[slot] >= 0 && keys[slot] != color) slot = (slot + 1) & 1023;
+                if (values[slot] < 0) {
+                    if (frame.palette.size() == 256) {
+                        frame.palette.clear();
+                        frame.pixels.clear();
+                        frame.argb.assign(pixels, pixels + count);
+                        for (uint32_t &pixel : frame.argb) pixel = scale_pixel(pixel, opacity_alpha);
+                        indexed.push_back(std::move(frame));
+                        return;
+                    }
+                    keys[slot] = color;
+                    values[slot] = (int16_t)frame.palette.size();
+                    frame.palette.push_back(color);
+                }
+                last_color = color;
+                last_index = (uint8_t)values[slot];
+            }
+            frame.pixels[i] = last_index;
+        }
+        for (uint32_t &color : frame.palette) color = scale_pixel(color, opacity_alpha);
+        indexed.push_back(std::move(frame));
+    }
+
+    // Bring the scratch surface from the frame it holds to frame index,
+    // touching only the pixels that changed on the way
+    void expand_frame(size_t index) {
+        GdkRectangle rect = {0, 0, width, height};
+        if (shown_index < size()) {
+            rect = {0, 0, 0, 0};
+            for (size_t i = shown_index; i != index;) {
+                i = (i + 1) % size();
+                rect = union_rect(rect, damages[i]);
+            }
+        }
+        shown_index = index;
+        if (rect.width <= 0) return;
+
+        cairo_surface_t *scratch = surfaces[0];
+        cairo_surface_flush(scratch);
+        unsigned char *data = cairo_image_surface_get_data(scratch);
+        int stride = cairo_image_surface_get_stride(scratch);
+        const IndexedFrame &frame = indexed[index];
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            uint32_t *row = reinterpret_cast<uint32_t*>(data + y * stride) + rect.x;
+            size_t offset = (size_t)y * width + rect.x;
+            if (frame.argb.empty()) {
+                expand_indices(&frame.pixels[offset], row, rect.width, frame.palette.data(), -1);
+            } else {
+                memcpy(row, &frame.argb[offset], rect.width * 4);
+            }
+        }
+        apply_corners(data, stride, rect);
+        cairo_surface_mark_dirty_rectangle(scratch, rect.x, rect.y, rect.width, rect.height);
+    }
+
+    bool start_stream() {
+        decoder.reset(file.data, file.size, info);
+        for (int i = 0; i < std::max(2, STREAM_RING_FRAMES); i++) {
+            cairo_surface_t *surface = frame_surface(width, height);
+            if (!surface) return false;
+            surfaces.push_back(surface);
+            free_slots.push_back(i);
+        }
+        worker = std::thread(&FrameCache::decode_ahead, this);
+        return true;
+    }
+
+    // Worker thread: keep every free slot filled with the next frame
+    void decode_ahead() {
+        std::unique_lock<std::mutex> lock(ring_mutex);
+        for (;;) {
+            ring_changed.wait(lock, [this] { return stopping || !free_slots.empty(); });
+            if (stopping) return;
+            int slot = free_slots.back();
+            free_slots.pop_back();
+            lock.unlock();
+
+            size_t index = decoder.next();
+            cairo_surface_t *surface = surfaces[slot];
+            decoder.decode_next(cairo_image_surface_get_data(surface), cairo_image_surface_get_stride(surface));
+            finish_frame(surface);
+
+            lock.lock();
+            ready.emplace_back(index, slot);
+            ring_changed.notify_all();
+        }
+    }
+
+    // Upper bound from the GIF descriptors: a frame changes its own rectangle
+    // plus whatever the previous frame's disposal restores. Looping back to
+    // frame 0 starts again from a cleared canvas, so that is a full redraw.
+    void compute_descriptor_damage(const GifInfo &info) {
+        GdkRectangle full = {0, 0, width, height};
+        damages.assign(delays.size(), full);
+        for (size_t i = 1; i < std::min(info.frames.size(), damages.size()); i++) {
+            const GifFrameInfo &frame = info.frames[i];
+            const GifFrameInfo &previous = info.frames[i - 1];
+            GdkRectangle rect = {frame.x, frame.y, frame.width, frame.height};
+            if (previous.disposal == 2 || previous.disposal == 3) {
+                GdkRectangle restored = {previous.x, previous.y, previous.width, previous.height};
+                rect = union_rect(rect, restored);
+            }
+            damages[i] = intersect_rect(rect, full);
+        }
+    }
 
-        // Load animated GIF
-        GError *error = nullptr;
-        animation = gdk_pixbuf_animation_new_from_file(gif_path, &error);
-        if (!animation) {
-            std::cerr << "Failed to load GIF: " << error->message << std::endl;
-            g_error_free(error);
+    // Decoded frames: shrink frame index's rectangle to the pixels that differ
+    // between a (the frame before it) and b
+    void tighten_damage(size_t index, const unsigned char *a, const unsigned char *b, int stride) {
+        GdkRectangle rect = damages[index];
+        int x1 = INT32_MAX, y1 = INT32_MAX, x2 = -1, y2 = -1;
+        for (int y = rect.y; y < rect.y + rect.height; y++) {
+            const uint32_t *row_a = reinterpret_cast<const uint32_t*>(a + y * stride);
+            const uint32_t *row_b = reinterpret_cast<const uint32_t*>(b + y * stride);
+            if (memcmp(row_a + rect.x, row_b + rect.x, rect.width * 4) == 0) continue;
+            int left = rect.x, right = rect.x + rect.width - 1;
+            while (row_a[left] == row_b[left]) left++;
+            while (row_a[right] == row_b[right]) right--;
+            x1 = std::min(x1, left);
+            x2 = std::max(x2, right);
+            y1 = std::min(y1, y);
+            y2 = y;
+        }
+        damages[index] = x2 < 0 ? GdkRectangle{0, 0, 0, 0}
+                                : GdkRectangle{x1, y1, x2 - x1 + 1, y2 - y1 + 1};
+    }
+
+    // An ARGB32 surface, or nullptr when cairo could not make one
+    static cairo_surface_t *frame_surface(int width, int height) {
+        cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+        if (cairo_surface_status(surface) == CAIRO_STATUS_SUCCESS) return surface;
+        cairo_surface_destroy(surface);
+        return nullptr;
+    }
+
+    void build_corner_mask() {
+        corner_radius = std::min({CORNER_RADIUS, width / 2, height / 2});
+        if (corner_radius <= 0) return;
+
+        int size = corner_radius * 2;
+        cairo_surface_t *mask = cairo_image_surface_create(CAIRO_FORMAT_A8, size, size);
+        if (cairo_surface_status(mask) != CAIRO_STATUS_SUCCESS) {
+            cairo_surface_destroy(mask);
+            corner_radius = 0;  // Square corners, but the frames still show
             return;
         }
+        cairo_t *cr = cairo_create(mask);
+        cairo_arc(cr, corner_radius, corner_radius, corner_radius, 0, 2 * M_PI);
+        cairo_fill(cr);
+        cairo_destroy(cr);
+        cairo_surface_flush(mask);
+
+        const unsigned char *data = cairo_image_surface_get_data(mask);
+        int stride = cairo_image_surface_get_stride(mask);
+        corner_mask.resize(size * size);
+        for (int y = 0; y < size; y++) {
+            memcpy(&corner_mask[y * size], data + y * stride, size);
+        }
+        cairo_surface_destroy(mask);
+    }
+
+    // Decode-time finishing so playback stays a plain blit: opacity, then corners
+    void finish_frame(cairo_surface_t *surface) const {
+        if (corner_radius <= 0 && opacity_alpha == 255) return;
+
+        cairo_surface_flush(surface);
+        unsigned char *data = cairo_image_surface_get_data(surface);
+        int stride = cairo_image_surface_get_stride(surface);
+
+        if (opacity_alpha != 255) {
+            for (int y = 0; y < height; y++) {
+                uint32_t *row = reinterpret_cast<uint32_t*>(data + y * stride);
+                for (int x = 0; x < width; x++) row[x] = scale_pixel(row[x], opacity_alpha);
+            }
+        }
+
+        apply_corners(data, stride, {0, 0, width, height});
+        cairo_surface_mark_dirty(surface);
+    }
 
-        int gif_width = gdk_pixbuf_animation_get_width(animation);
-        int gif_height = gdk_pixbuf_animation_get_height(animation);
+    // Rounded-corner coverage for the part of the corners inside rect
+    void apply_corners(unsigned char *data, int stride, const GdkRectangle &rect) const {
+        int r = corner_radius;
+        if (r <= 0) return;
+        for (int corner = 0; corner < 4; corner++) {
+            int frame_x = (corner & 1) ? width - r : 0;
+            int frame_y = (corner & 2) ? height - r : 0;
+            GdkRectangle area = intersect_rect({frame_x, frame_y, r, r}, rect);
+            int mask_x = ((corner & 1) ? r : 0) + area.x - frame_x;
+            int mask_y = ((corner & 2) ? r : 0) + area.y - frame_y;
+            for (int y = 0; y < area.height; y++) {
+                const uint8_t *coverage = &corner_mask[(mask_y + y) * r * 2 + mask_x];
+                uint32_t *row = reinterpret_cast<uint32_t*>(data + (area.y + y) * stride) + area.x;
+                for (int x = 0; x < area.width; x++) {
+                    if (coverage[x] != 255) row[x] = scale_pixel(row[x], coverage[x]);
+                }
+            }
+        }
+    }
+
+    // Premultiplied pixel times alpha / 255, all four channels
+    static uint32_t scale_pixel(uint32_t pixel, uint32_t alpha) {
+        uint32_t out = 0;
+        for (int shift = 0; shift < 32; shift += 8) {
+            uint32_t channel = (pixel >> shift) & 0xFF;
+            out |= ((channel * alpha + 127) / 255) << shift;
+        }
+        return out;
+    }
+
+    // Straight RGB(A) to cairo's native-endian premultiplied ARGB32
+    static void to_premultiplied(GdkPixbuf *pixbuf, cairo_surface_t *surface) {
+        cairo_surface_flush(surface);
+        int w = gdk_pixbuf_get_width(pixbuf);
+        int h = gdk_pixbuf_get_height(pixbuf);
+        int channels = gdk_pixbuf_get_n_channels(pixbuf);
+        int src_stride = gdk_pixbuf_get_rowstride(pixbuf);
+        const guchar *src = gdk_pixbuf_read_pixels(pixbuf);
+        unsigned char *dst = cairo_image_surface_get_data(surface);
+        int dst_stride = cairo_image_surface_get_stride(surface);
+
+        for (int y = 0; y < h; y++) {
+            const guchar *p = src + y * src_stride;
+            uint32_t *q = reinterpret_cast<uint32_t*>(dst + y * dst_stride);
+            for (int x = 0; x < w; x++, p += channels) {
+                uint32_t a = channels == 4 ? p[3] : 255;
+                uint32_t r = (p[0] * a + 127) / 255;
+                uint32_t g = (p[1] * a + 127) / 255;
+                uint32_t b = (p[2] * a + 127) / 255;
+                q[x] = a << 24 | r << 16 | g << 8 | b;
+            }
+        }
+        cairo_surface_mark_dirty(surface);
+    }
+};
+
+class GifPlayer {
+#ifdef GWS_BENCH
+    friend void run_gif_bench(const char* gif_path, int iterations, OpacityMode opacity_mode,
+                              FrameStorage storage);
+#endif
+public:
+    // Decodes the animation (or starts streaming it); run() opens the window and plays it
+    GifPlayer(const char* gif_path, int top_margin = TOP_MARGIN, int right_margin = RIGHT_MARGIN,
+              OpacityMode opacity_mode = OPACITY_MODE, FrameStorage storage = FRAME_STORAGE)
+        : top_margin(top_margin), right_margin(right_margin), opacity_mode(opacity_mode) {
+        std::string error;
+        loaded = frames.load(gif_path, opacity_mode == OPACITY_BAKED ? OPACITY : 1.0, storage, error);
+        if (!loaded) {
+            std::cerr << "Failed to load GIF: " << error << std::endl;
+        }
+    }
+
+    ~GifPlayer() {
+        if (wake_timer) g_source_remove(wake_timer);
+    }
+
+    // Frame pacing counters since playback started
+    struct PlaybackStats {
+        unsigned long shown = 0;    // Frames drawn
+        unsigned long dropped = 0;  // Frames skipped because their time had already passed
+        unsigned long late = 0;     // Frames drawn more than one refresh after they were due
+    };
+
+    const PlaybackStats &playback_stats() const { return stats; }
+
+    bool run() {
+        if (!loaded) return false;
+
+        gtk_init(nullptr, nullptr);
+
+        int gif_width = frames.frame_width();
+        int gif_height = frames.frame_height();
 
         // Create window
         window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
@@ -43,6 +1447,10 @@ public:
         gtk_window_set_skip_taskbar_hint(GTK_WINDOW(window), TRUE);
         gtk_window_set_skip_pager_hint(GTK_WINDOW(window), TRUE);
 
+        if (opacity_mode == OPACITY_COMPOSITOR) {
+            gtk_widget_set_opacity(window, OPACITY);
+        }
+
         // Set transparency
         g_signal_connect(window, "screen-changed", G_CALLBACK(on_screen_changed), nullptr);
         on_screen_changed(window, nullptr, nullptr);
@@ -52,10 +1460,6 @@ public:
         int y = top_margin;
         gtk_window_move(GTK_WINDOW(window), x, y);
 
-        // Add GIF image
-        image = gtk_image_new_from_animation(animation);
-        gtk_container_add(GTK_CONTAINER(window), image);
-
         // Connect signals
         g_signal_connect(window, "button-press-event", G_CALLBACK(on_button_press), nullptr);
         g_signal_connect(window, "draw", G_CALLBACK(on_draw), this);
@@ -64,19 +1468,140 @@ public:
         gtk_widget_add_events(window, GDK_BUTTON_PRESS_MASK);
         gtk_widget_show_all(window);
 
+        // GIF_PLAYER_STATS=1 prints the pacing counters once per loop
+        print_stats = getenv("GIF_PLAYER_STATS") != nullptr;
+        if (frames.size() > 1) start_ticking();
+
         gtk_main();
+        return true;
     }
 
-    ~GifPlayer() {
-        if (animation) {
-            g_object_unref(animation);
+private:
+    GtkWidget *window = nullptr;
+    FrameCache frames;
+    bool loaded = false;
+    int top_margin;
+    int right_margin;
+    OpacityMode opacity_mode;
+
+    // Playback position
+    size_t current = 0;
+    int loops_played = 0;
+
+    // Frame clock scheduling
+    guint tick_id = 0;
+    guint wake_timer = 0;
+    gint64 frame_due = 0;  // Frame-clock time (us) at which the current frame ends
+    PlaybackStats stats;
+    bool print_stats = false;
+
+    static gint64 delay_us(int delay_ms) {
+        return (delay_ms < MIN_FRAME_DELAY_MS ? CLAMPED_FRAME_DELAY_MS : delay_ms) * 1000LL;
+    }
+
+    gint64 loop_duration_us() const {
+        gint64 total = 0;
+        for (size_t i = 0; i < frames.size(); i++) total += delay_us(frames.delay(i));
+        return total;
+    }
+
+    void start_ticking() {
+        tick_id = gtk_widget_add_tick_callback(window, on_frame_tick, this, nullptr);
+    }
+
+    static gboolean on_frame_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer data) {
+        auto *self = static_cast<GifPlayer*>(data);
+        gint64 now = gdk_frame_clock_get_frame_time(clock);
+        gint64 refresh_us = 0, presentation_time = 0;
+        gdk_frame_clock_get_refresh_info(clock, now, &refresh_us, &presentation_time);
+        if (refresh_us <= 0) refresh_us = 16667;
+
+        if (self->advance(now, refresh_us)) return G_SOURCE_CONTINUE;
+        self->tick_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+
+    // Show whichever frame is due at frame time now, dropping any whose time
+    // has already passed. Returns false when the tick callback should go:
+    // playback finished, or the next frame is far enough off to sleep.
+    bool advance(gint64 now, gint64 refresh_us) {
+        if (frame_due == 0) frame_due = now + delay_us(frames.delay(current));
+
+        if (now >= frame_due) {
+            // Stalled longer than a whole loop (suspend, blocked main loop): restart the clock
+            if (now - frame_due > loop_duration_us()) frame_due = now;
+
+            unsigned long steps = 0;
+            GdkRectangle dirty = {0, 0, 0, 0};
+            while (now >= frame_due) {
+                if (!step()) {
+                    gtk_widget_queue_draw(window);
+                    return false;
+                }
+                frame_due += delay_us(frames.delay(current));
+                dirty = union_rect(dirty, frames.damage(current));
+                steps++;
+                if (current == 0 && print_stats) {
+                    g_print("GIF frames shown %lu, dropped %lu, late %lu\n",
+                            stats.shown, stats.dropped, stats.late);
+                }
+            }
+
+            gint64 shown_due = frame_due - delay_us(frames.delay(current));
+            stats.shown++;
+            stats.dropped += steps - 1;
+            if (now - shown_due > refresh_us) stats.late++;
+
+            // Only the pixels that changed since the frame on screen
+            if (dirty.width > 0) {
+                gtk_widget_queue_draw_area(window, dirty.x, dirty.y, dirty.width, dirty.height);
+            }
         }
+
+        // Long delays: stop ticking every refresh, wake up just before the frame
+        gint64 wait = frame_due - now;
+        if (wait > 3 * refresh_us) {
+            wake_timer = g_timeout_add((guint)((wait - 2 * refresh_us) / 1000), on_wake, this);
+            return false;
+        }
+        return true;
     }
 
-private:
-    GtkWidget *window;
-    GtkWidget *image;
-    GdkPixbufAnimation *animation;
+    static gboolean on_wake(gpointer data) {
+        auto *self = static_cast<GifPlayer*>(data);
+        self->wake_timer = 0;
+        self->start_ticking();
+        return G_SOURCE_REMOVE;
+    }
+
+    // Advance one frame; false once a finite loop count has been played out
+    bool step() {
+        if (current + 1 == frames.size()) {
+            loops_played++;
+            if (frames.loops() > 0 && loops_played >= frames.loops()) return false;
+        }
+        current = (current + 1) % frames.size();
+        return true;
+    }
+
+    // Blit the current frame at the configured opacity
+    void render(cairo_t *cr) {
+        if (opacity_mode != OPACITY_PER_FRAME) {
+            // Frame covers the window and already carries its alpha: one copy, no blend
+            cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+            cairo_set_source_surface(cr, frames.surface(current), 0, 0);
+            cairo_paint(cr);
+            return;
+        }
+
+        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
+        cairo_set_source_rgba(cr, 0, 0, 0, 0); // Clear background
+        cairo_paint(cr);
+
+        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
+        cairo_set_source_surface(cr, frames.surface(current), 0, 0);
+        cairo_paint_with_alpha(cr, OPACITY);
+    }
 
     static void on_screen_changed(GtkWidget *widget, GdkScreen *old_screen, gpointer user_data) {
         GdkScreen *screen = gtk_widget_get_screen(widget);
@@ -86,14 +1611,7 @@ private:
     }
 
     static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
-        // Apply opacity to entire widget
-        cairo_set_operator(cr, CAIRO_OPERATOR_SOURCE);
-        cairo_set_source_rgba(cr, 0, 0, 0, 0); // Clear background
-        cairo_paint(cr);
-        
-        cairo_set_operator(cr, CAIRO_OPERATOR_OVER);
-        cairo_paint_with_alpha(cr, OPACITY);
-        
+        static_cast<GifPlayer*>(data)->render(cr);
         return FALSE;
     }
 
@@ -109,6 +1627,239 @@ private:
     }
 };
 
+#ifdef GWS_BENCH
+#include "gws_bench.h"
+#include <sys/wait.h>
+
+// Reads every page of every frame, as playback eventually does
+static void bench_touch_frames(FrameCache &frames) {
+    volatile uint8_t sink = 0;
+    for (size_t i = 0; i < frames.size(); i++) {
+        cairo_surface_t *surface = frames.surface(i);
+        const uint8_t *pixels = cairo_image_surface_get_data(surface);
+        size_t bytes = (size_t)cairo_image_surface_get_stride(surface) * frames.frame_height();
+        for (size_t offset = 0; offset < bytes; offset += 4096) sink = sink + pixels[offset];
+    }
+}
+
+// Offscreen playback: decode the whole animation, then paint frame after
+// frame exactly as on_draw does
+void run_gif_bench(const char* gif_path, int iterations, OpacityMode opacity_mode, FrameStorage storage) {
+    static const char *mode_names[] = {"opacity baked", "opacity by compositor", "opacity per frame"};
+    static const char *storage_names[] = {"auto", "all frames cached", "palette indexed", "streamed"};
+    static const char *source_names[] = {"", " from disk cache", " shared by another instance"};
+    long rss_before = bench_status_kb("VmRSS:");
+    double start = bench_now_ms();
+    GifPlayer player(gif_path, TOP_MARGIN, RIGHT_MARGIN, opacity_mode, storage);
+    double load_ms = bench_now_ms() - start;
+    if (!player.loaded) return;
+
+    int width = player.frames.frame_width();
+    int height = player.frames.frame_height();
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, width, height);
+    cairo_t *cr = cairo_create(surface);
+
+    BenchFrames paint;
+    double cpu_start = bench_cpu_ms();
+    for (int i = 0; i < iterations; i++) {
+        player.current = i % player.frames.size();
+        paint.run([&] { player.render(cr); });
+    }
+    double cpu_per_frame = (bench_cpu_ms() - cpu_start) / std::max(1, iterations);
+
+    // What a queue_draw_area invalidation repaints: the frame clipped to its damage
+    BenchFrames damaged;
+    double damaged_pixels = 0;
+    for (int i = 0; i < iterations; i++) {
+        player.current = i % player.frames.size();
+        const GdkRectangle &damage = player.frames.damage(player.current);
+        damaged_pixels += (double)damage.width * damage.height;
+        damaged.run([&] {
+            cairo_save(cr);
+            cairo_rectangle(cr, damage.x, damage.y, damage.width, damage.height);
+            cairo_clip(cr);
+            player.render(cr);
+            cairo_restore(cr);
+        });
+    }
+
+    printf("gif %s (%dx%d, %zu frames, %s%s, %s):\n", gif_path, width, height, player.frames.size(),
+           storage_names[player.frames.storage()],
+           source_names[player.frames.store_source()], mode_names[opacity_mode]);
+    if (player.frames.storage() == STORAGE_INDEXED) {
+        printf("  over 256 colors        %zu frames, stored whole\n", player.frames.full_color_frames());
+    }
+    printf("  load and decode        %.3f ms, +%ld kB RSS\n", load_ms, bench_status_kb("VmRSS:") - rss_before);
+    paint.print("paint frame");
+    damaged.print("paint damaged area");
+    printf("  damaged area           %.1f%% of the frame\n",
+           100.0 * damaged_pixels / ((double)width * height * std::max(1, iterations)));
+    printf("  cpu per frame          %.3f ms\n", cpu_per_frame);
+    bench_print_memory();
+
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+// The same GIF in several processes at once, as with one player per screen:
+// the first decodes, the rest attach to its frames (through the disk cache
+// or the shared memfd). Total PSS counts every shared page once.
+void run_share_bench(const char* gif_path, int instances) {
+    std::string error;
+    FrameCache first;
+    if (!first.load(gif_path, OPACITY, STORAGE_CACHED, error)) return;
+    size_t frame_kb = (size_t)cairo_image_surface_get_stride(first.surface(0)) * first.frame_height() * first.size() / 1024;
+
+    // Children report where their frames came from, then stay alive until
+    // released so that every mapping is counted together
+    int results[2], release[2];
+    if (pipe(results) != 0 || pipe(release) != 0) return;
+    std::vector<pid_t> children;
+    for (int i = 1; i < instances; i++) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(release[1]);
+            FrameCache other;
+            other.load(gif_path, OPACITY, STORAGE_CACHED, error);
+            bench_touch_frames(other);
+            int source = other.store_source();
+            char byte;
+            if (write(results[1], &source, sizeof source) == sizeof source) read(release[0], &byte, 1);
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    close(results[1]);
+    close(release[0]);
+    bench_touch_frames(first);
+
+    // This process serves the memfd from the main loop, as a player would
+    int sources[3] = {1, 0, 0};
+    struct Pending { int *sources; int left; } pending = {sources, instances - 1};
+    auto on_result = [](gint fd, GIOCondition, gpointer data) -> gboolean {
+        auto *pending = static_cast<Pending*>(data);
+        int source;
+        if (read(fd, &source, sizeof source) != sizeof source) {
+            pending->left = 0;  // A child died
+            return G_SOURCE_REMOVE;
+        }
+        pending->sources[std::clamp(source, 0, 2)]++;
+        return --pending->left > 0 ? G_SOURCE_CONTINUE : G_SOURCE_REMOVE;
+    };
+    g_unix_fd_add(results[0], G_IO_IN, on_result, &pending);
+    while (pending.left > 0) g_main_context_iteration(nullptr, TRUE);
+
+    long total_pss = bench_pss_kb(getpid());
+    for (pid_t pid : children) total_pss += bench_pss_kb(pid);
+    printf("share %s (%d instances, %zu kB of frames each):\n", gif_path, instances, frame_kb);
+    printf("  frames                 %d decoded, %d from disk cache, %d shared\n", sources[0], sources[1], sources[2]);
+    printf("  total PSS              %ld kB, %ld kB per instance\n", total_pss, total_pss / instances);
+    printf("  frames unshared        %zu kB\n", frame_kb * instances);
+
+    close(release[1]);
+    for (pid_t pid : children) waitpid(pid, nullptr, 0);
+    close(results[0]);
+}
+
+// Every frame of the GIF to premultiplied ARGB32, passes times over: through
+// gdk-pixbuf's animation iterator, as the player used to, and with GifDecoder
+void run_decode_bench(const char* gif_path, int passes) {
+    MappedFile file;
+    GifInfo info;
+    if (!file.open(gif_path) || !info.scan(file.data, file.size)) {
+        std::cerr << gif_path << ": not a GIF" << std::endl;
+        return;
+    }
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, info.width, info.height);
+    unsigned char *pixels = cairo_image_surface_get_data(surface);
+    int stride = cairo_image_surface_get_stride(surface);
+
+    BenchFrames gdk_pixbuf, builtin;
+    for (int pass = 0; pass < passes; pass++) {
+        gdk_pixbuf.run([&] {
+            GdkPixbufAnimation *animation = gdk_pixbuf_animation_new_from_file(gif_path, nullptr);
+            if (!animation) return;
+            GTimeVal time = {0, 0};
+            GdkPixbufAnimationIter *iter = gdk_pixbuf_animation_get_iter(animation, &time);
+            for (size_t i = 0; i < info.frames.size(); i++) {
+                FrameCache::to_premultiplied(gdk_pixbuf_animation_iter_get_pixbuf(iter), surface);
+                time.tv_usec += std::max(0, gdk_pixbuf_animation_iter_get_delay_time(iter)) * 1000L;
+                time.tv_sec += time.tv_usec / 1000000;
+                time.tv_usec %= 1000000;
+                gdk_pixbuf_animation_iter_advance(iter, &time);
+            }
+            g_object_unref(iter);
+            g_object_unref(animation);
+        });
+        builtin.run([&] {
+            GifInfo scanned;
+            scanned.scan(file.data, file.size);
+            GifDecoder decoder;
+            decoder.reset(file.data, file.size, scanned);
+            for (size_t i = 0; i < scanned.frames.size(); i++) decoder.decode_next(pixels, stride);
+        });
+    }
+
+    printf("decode %s (%dx%d, %zu frames, %zu kB):\n", gif_path, info.width, info.height,
+           info.frames.size(), file.size / 1024);
+    gdk_pixbuf.print("gdk-pixbuf");
+    builtin.print("GifDecoder");
+    cairo_surface_destroy(surface);
+}
+
+// Offscreen benchmark: gif_bench <gif_path>... [frames]. Playback of the first
+// GIF in each configuration, then decode throughput for every GIF.
+int main(int argc, char** argv) {
+    std::vector<const char*> gifs;
+    int iterations = 300;
+    for (int i = 1; i < argc; i++) {
+        if (strspn(argv[i], "0123456789") == strlen(argv[i])) {
+            iterations = atoi(argv[i]);
+        } else {
+            gifs.push_back(argv[i]);
+        }
+    }
+    if (gifs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " <gif_path>... [frames]" << std::endl;
+        return 1;
+    }
+
+    // One child per run so each RSS figure starts from a clean process: every
+    // opacity mode with the configured storage (the first twice, so the second
+    // start can use the disk cache the first wrote), then indexed and streamed
+    struct { OpacityMode opacity; FrameStorage storage; } runs[] = {
+        {OPACITY_BAKED, FRAME_STORAGE},
+        {OPACITY_BAKED, FRAME_STORAGE},
+        {OPACITY_COMPOSITOR, FRAME_STORAGE},
+        {OPACITY_PER_FRAME, FRAME_STORAGE},
+        {OPACITY_BAKED, STORAGE_INDEXED},
+        {OPACITY_BAKED, STORAGE_STREAMED},
+    };
+    for (const auto &run : runs) {
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            run_gif_bench(gifs[0], iterations, run.opacity, run.storage);
+            fflush(stdout);
+            _exit(0);
+        }
+        waitpid(pid, nullptr, 0);
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        run_share_bench(gifs[0], 4);
+        fflush(stdout);
+        _exit(0);
+    }
+    waitpid(pid, nullptr, 0);
+
+    for (const char *gif : gifs) run_decode_bench(gif, std::max(1, iterations / 30));
+    return 0;
+}
+#else
 int main(int argc, char** argv) {
     if (argc < 2) {
         std::cerr << "Usage: " << argv[0] << " <gif_path>" << std::endl;
@@ -116,5 +1867,6 @@ int main(int argc, char** argv) {
     }
 
     GifPlayer player(argv[1]);
-    return 0;
+    return player.run() ? 0 : 1;
 }
+#endif
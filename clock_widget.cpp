@@ -6,10 +6,24 @@
 #include <vector>
 #include <cmath>
 #include <sys/time.h>
+#include <sys/timerfd.h>
+#include <sys/inotify.h>
+#include <sys/timex.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <climits>
 #include <unistd.h>
+#include <cerrno>
+#include <glib-unix.h>
 #include <cstdlib>
 #include <fstream>
 #include <sstream>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
 
 // ---------------- CONFIG ----------------
 const int SCREEN_WIDTH  = 1920;
@@ -21,6 +35,32 @@ const double BG_RED   = 0.12;
 const double BG_GREEN = 0.12;
 const double BG_BLUE  = 0.13;
 
+// false = minute-hand-only mode: no second hand, one wakeup per minute
+const bool SHOW_SECOND_HAND = true;
+
+// Blit hands from pre-rendered sprites (one per hand position) instead of stroking them
+const bool HAND_SPRITES = false;
+
+// Smooth-sweep second hand driven by the window's frame clock (needs SHOW_SECOND_HAND).
+// Falls back to 1 Hz ticking when a frame takes longer than the budget to draw.
+const bool SWEEP_SECOND_HAND = false;
+const int SWEEP_MAX_FPS = 30;               // Frame-rate ceiling, e.g. 20 / 30 / 60
+const double SWEEP_FRAME_BUDGET_MS = 4.0;   // Average draw time allowed per frame
+
+// Show the kernel's clock sync state / estimated error in the top-right corner
+const bool SHOW_SYNC_STATUS = false;
+
+// Optional SNTP drift estimator for RTC-only systems: "host" or "host:port",
+// empty = disabled. Only the drawn hands are corrected, never the system clock.
+// CLOCK_NTP_SERVER overrides this, e.g. to point at a local test responder.
+const std::string NTP_SERVER = "";
+const int NTP_POLL_SECONDS = 64;
+
+// Clock grid: cells are laid out left to right, CLOCK_COLUMNS per row
+const int CLOCK_COLUMNS     = 4;
+const int CLOCK_CELL_WIDTH  = 130;
+const int CLOCK_CELL_HEIGHT = 160;
+
 // Your timezone (system will auto-detect, but you can override)
 const std::string YOUR_TIMEZONE = "Asia/Singapore";
 
@@ -37,6 +77,386 @@ const TimezoneConfig TIMEZONE_CONFIGS[] = {
     {"Helsinki", "Today", "Europe/Helsinki"}
 };
 
+// ---------------- ZONEINFO ----------------
+// Native reader for the TZif files in /usr/share/zoneinfo (RFC 8536).
+// Each zone is parsed once into a transition table; lookups are a binary
+// search, with the POSIX TZ footer covering instants past the last transition.
+class ZoneInfo {
+public:
+    struct LocalTimeType {
+        int utc_offset;
+        bool is_dst;
+        std::string abbreviation;
+    };
+
+    static std::shared_ptr<const ZoneInfo> load(const std::string& tz_identifier) {
+        if (tz_identifier.empty() || tz_identifier[0] == '/' ||
+            tz_identifier.find("..") != std::string::npos) {
+            return nullptr;
+        }
+
+        const char* tzdir = getenv("TZDIR");
+        std::string path = std::string(tzdir ? tzdir : "/usr/share/zoneinfo") + "/" + tz_identifier;
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) return nullptr;
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)),
+                                        std::istreambuf_iterator<char>());
+
+        auto zone = std::make_shared<ZoneInfo>();
+        if (!zone->parse(data)) return nullptr;
+        return zone;
+    }
+
+    // Offset and DST flag in effect at UTC instant t
+    const LocalTimeType& lookup(int64_t t) const {
+        if (transitions.empty() || t < transitions.front()) {
+            if (transitions.empty() && has_footer) return footerLookup(t);
+            return types[0];
+        }
+        if (t >= transitions.back() && has_footer) {
+            return footerLookup(t);
+        }
+        auto it = std::upper_bound(transitions.begin(), transitions.end(), t);
+        return types[transition_types[(it - transitions.begin()) - 1]];
+    }
+
+    // First instant after t at which the zone's local time type changes,
+    // or INT64_MAX when the zone has no further transitions
+    int64_t nextTransition(int64_t t) const {
+        auto it = std::upper_bound(transitions.begin(), transitions.end(), t);
+        if (it != transitions.end()) return *it;
+        if (!has_footer || !footer_has_dst) return INT64_MAX;
+
+        int64_t year = yearOf(t + footer_std.utc_offset);
+        int64_t next = INT64_MAX;
+        for (int64_t y = year; y <= year + 1; y++) {
+            int64_t start = ruleLocalTime(dst_start, y) - footer_std.utc_offset;
+            int64_t end = ruleLocalTime(dst_end, y) - footer_dst.utc_offset;
+            if (start > t) next = std::min(next, start);
+            if (end > t) next = std::min(next, end);
+        }
+        return next;
+    }
+
+    // localtime_r() for this zone. Reads only immutable tables, so it needs
+    // no TZ/tzset() and is safe to call from any thread.
+    void localTime(int64_t t, struct tm* out) const {
+        const LocalTimeType& type = lookup(t);
+        int64_t local = t + type.utc_offset;
+        int64_t days = floorDiv(local, 86400);
+        int secs = static_cast<int>(local - days * 86400);
+
+        int64_t y;
+        int m, d;
+        civilFromDays(days, y, m, d);
+
+        out->tm_sec = secs % 60;
+        out->tm_min = (secs / 60) % 60;
+        out->tm_hour = secs / 3600;
+        out->tm_mday = d;
+        out->tm_mon = m - 1;
+        out->tm_year = static_cast<int>(y - 1900);
+        out->tm_wday = static_cast<int>(((days + 4) % 7 + 7) % 7);
+        out->tm_yday = static_cast<int>(days - daysFromCivil(y, 1, 1));
+        out->tm_isdst = type.is_dst ? 1 : 0;
+        out->tm_gmtoff = type.utc_offset;
+        out->tm_zone = type.abbreviation.c_str();
+    }
+
+private:
+    // Rule date as written in a POSIX TZ string: Jn, n or Mm.w.d
+    struct RuleDate {
+        enum Kind { JULIAN, ZERO_BASED, MONTH_WEEK_DAY } kind = MONTH_WEEK_DAY;
+        int day = 0;
+        int month = 0;
+        int week = 0;
+        int time = 7200; // 02:00:00 local unless stated
+    };
+
+    std::vector<int64_t> transitions;
+    std::vector<uint8_t> transition_types;
+    std::vector<LocalTimeType> types;
+
+    bool has_footer = false;
+    bool footer_has_dst = false;
+    LocalTimeType footer_std;
+    LocalTimeType footer_dst;
+    RuleDate dst_start;
+    RuleDate dst_end;
+
+    static int64_t readBE(const unsigned char* p, int bytes) {
+        uint64_t v = 0;
+        for (int i = 0; i < bytes; i++) v = (v << 8) | p[i];
+        if (bytes == 4) return static_cast<int32_t>(v);
+        return static_cast<int64_t>(v);
+    }
+
+    bool parse(const std::vector<unsigned char>& data) {
+        const size_t header_size = 44;
+        if (data.size() < header_size || memcmp(data.data(), "TZif", 4) != 0) return false;
+
+        char version = data[4];
+        size_t pos = 0;
+        int time_size = 4;
+
+        // v2+ files repeat the data block with 64-bit times; skip the v1 block
+        if (version >= '2') {
+            size_t v1_size = blockSize(data.data(), 4);
+            pos = header_size + v1_size;
+            if (data.size() < pos + header_size || memcmp(data.data() + pos, "TZif", 4) != 0) return false;
+            time_size = 8;
+        }
+
+        const unsigned char* h = data.data() + pos;
+        uint32_t isutcnt  = readBE(h + 20, 4);
+        uint32_t isstdcnt = readBE(h + 24, 4);
+        uint32_t leapcnt  = readBE(h + 28, 4);
+        uint32_t timecnt  = readBE(h + 32, 4);
+        uint32_t typecnt  = readBE(h + 36, 4);
+        uint32_t charcnt  = readBE(h + 40, 4);
+        if (typecnt == 0) return false;
+
+        pos += header_size;
+        if (data.size() < pos + blockSize(h, time_size)) return false;
+
+        const unsigned char* p = data.data() + pos;
+        transitions.resize(timecnt);
+        for (uint32_t i = 0; i < timecnt; i++, p += time_size) {
+            transitions[i] = readBE(p, time_size);
+        }
+        transition_types.assign(p, p + timecnt);
+        p += timecnt;
+
+        const unsigned char* type_records = p;
+        p += typecnt * 6;
+        const char* abbrevs = reinterpret_cast<const char*>(p);
+        p += charcnt + leapcnt * (time_size + 4) + isstdcnt + isutcnt;
+
+        types.resize(typecnt);
+        for (uint32_t i = 0; i < typecnt; i++) {
+            const unsigned char* r = type_records + i * 6;
+            types[i].utc_offset = static_cast<int>(readBE(r, 4));
+            types[i].is_dst = r[4] != 0;
+            uint8_t idx = r[5];
+            if (idx < charcnt) {
+                types[i].abbreviation = std::string(abbrevs + idx, strnlen(abbrevs + idx, charcnt - idx));
+            }
+        }
+        for (uint8_t t : transition_types) {
+            if (t >= typecnt) return false;
+        }
+
+        // Footer: "\n<POSIX TZ string>\n", only present in v2+ files
+        if (time_size == 8) {
+            size_t footer_pos = p - data.data();
+            if (footer_pos < data.size() && data[footer_pos] == '\n') {
+                auto end = std::find(data.begin() + footer_pos + 1, data.end(), '\n');
+                std::string tz(data.begin() + footer_pos + 1, end);
+                has_footer = !tz.empty() && parsePosixTZ(tz);
+            }
+        }
+
+        return true;
+    }
+
+    static size_t blockSize(const unsigned char* h, int time_size) {
+        size_t isutcnt  = readBE(h + 20, 4);
+        size_t isstdcnt = readBE(h + 24, 4);
+        size_t leapcnt  = readBE(h + 28, 4);
+        size_t timecnt  = readBE(h + 32, 4);
+        size_t typecnt  = readBE(h + 36, 4);
+        size_t charcnt  = readBE(h + 40, 4);
+        return timecnt * time_size + timecnt + typecnt * 6 + charcnt +
+               leapcnt * (time_size + 4) + isstdcnt + isutcnt;
+    }
+
+    // ---- POSIX TZ footer, e.g. "EET-2EEST,M3.5.0/3,M10.5.0/4" ----
+
+    static bool parseAbbreviation(const std::string& s, size_t& i, std::string& out) {
+        if (i < s.size() && s[i] == '<') {
+            size_t end = s.find('>', i);
+            if (end == std::string::npos) return false;
+            out = s.substr(i + 1, end - i - 1);
+            i = end + 1;
+            return true;
+        }
+        size_t start = i;
+        while (i < s.size() && isalpha(static_cast<unsigned char>(s[i]))) i++;
+        out = s.substr(start, i - start);
+        return i - start >= 3;
+    }
+
+    // [+-]hh[:mm[:ss]], returned in seconds
+    static bool parseClock(const std::string& s, size_t& i, int& seconds) {
+        int sign = 1;
+        if (i < s.size() && (s[i] == '+' || s[i] == '-')) {
+            if (s[i] == '-') sign = -1;
+            i++;
+        }
+        int parts[3] = {0, 0, 0};
+        for (int n = 0; n < 3; n++) {
+            if (n > 0) {
+                if (i >= s.size() || s[i] != ':') break;
+                i++;
+            }
+            if (i >= s.size() || !isdigit(static_cast<unsigned char>(s[i]))) return false;
+            int v = 0;
+            while (i < s.size() && isdigit(static_cast<unsigned char>(s[i]))) v = v * 10 + (s[i++] - '0');
+            parts[n] = v;
+        }
+        seconds = sign * (parts[0] * 3600 + parts[1] * 60 + parts[2]);
+        return true;
+    }
+
+    static bool parseNumber(const std::string& s, size_t& i, int& value) {
+        if (i >= s.size() || !isdigit(static_cast<unsigned char>(s[i]))) return false;
+        value = 0;
+        while (i < s.size() && isdigit(static_cast<unsigned char>(s[i]))) value = value * 10 + (s[i++] - '0');
+        return true;
+    }
+
+    static bool parseRuleDate(const std::string& s, size_t& i, RuleDate& rule) {
+        if (i < s.size() && s[i] == 'M') {
+            i++;
+            rule.kind = RuleDate::MONTH_WEEK_DAY;
+            if (!parseNumber(s, i, rule.month) || i >= s.size() || s[i++] != '.') return false;
+            if (!parseNumber(s, i, rule.week) || i >= s.size() || s[i++] != '.') return false;
+            if (!parseNumber(s, i, rule.day)) return false;
+            if (rule.month < 1 || rule.month > 12 || rule.week < 1 || rule.week > 5 || rule.day > 6) return false;
+        } else if (i < s.size() && s[i] == 'J') {
+            i++;
+            rule.kind = RuleDate::JULIAN;
+            if (!parseNumber(s, i, rule.day) || rule.day < 1 || rule.day > 365) return false;
+        } else {
+            rule.kind = RuleDate::ZERO_BASED;
+            if (!parseNumber(s, i, rule.day) || rule.day > 365) return false;
+        }
+        if (i < s.size() && s[i] == '/') {
+            i++;
+            if (!parseClock(s, i, rule.time)) return false;
+        }
+        return true;
+    }
+
+    bool parsePosixTZ(const std::string& tz) {
+        size_t i = 0;
+        int std_offset;
+        if (!parseAbbreviation(tz, i, footer_std.abbreviation)) return false;
+        if (!parseClock(tz, i, std_offset)) return false;
+        footer_std.utc_offset = -std_offset; // POSIX offsets are west-positive
+        footer_std.is_dst = false;
+
+        if (i >= tz.size()) return true;
+
+        if (!parseAbbreviation(tz, i, footer_dst.abbreviation)) return false;
+        footer_dst.utc_offset = footer_std.utc_offset + 3600;
+        footer_dst.is_dst = true;
+        if (i < tz.size() && tz[i] != ',') {
+            int dst_offset;
+            if (!parseClock(tz, i, dst_offset)) return false;
+            footer_dst.utc_offset = -dst_offset;
+        }
+
+        if (i >= tz.size()) {
+            // No rule given: POSIX leaves it implementation-defined, use the US rule like glibc
+            dst_start.month = 3;  dst_start.week = 2; dst_start.day = 0;
+            dst_end.month = 11;   dst_end.week = 1;   dst_end.day = 0;
+        } else {
+            if (tz[i++] != ',' || !parseRuleDate(tz, i, dst_start)) return false;
+            if (i >= tz.size() || tz[i++] != ',' || !parseRuleDate(tz, i, dst_end)) return false;
+        }
+
+        footer_has_dst = true;
+        return true;
+    }
+
+    // Days since 1970-01-01 for a proleptic Gregorian date
+    static int64_t daysFromCivil(int64_t y, int m, int d) {
+        y -= m <= 2;
+        int64_t era = (y >= 0 ? y : y - 399) / 400;
+        int64_t yoe = y - era * 400;
+        int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + doe - 719468;
+    }
+
+    // Inverse of daysFromCivil
+    static void civilFromDays(int64_t days, int64_t& y, int& m, int& d) {
+        days += 719468;
+        int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        int64_t doe = days - era * 146097;
+        int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        int64_t mp = (5 * doy + 2) / 153;
+        d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+        m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+        y = yoe + era * 400 + (m <= 2);
+    }
+
+    static int64_t floorDiv(int64_t a, int64_t b) {
+        return a / b - (a % b != 0 && (a % b < 0) != (b < 0));
+    }
+
+    static int64_t yearOf(int64_t t) {
+        int64_t y;
+        int m, d;
+        civilFromDays(floorDiv(t, 86400), y, m, d);
+        return y;
+    }
+
+    static bool isLeapYear(int64_t y) {
+        return (y % 4 == 0 && y % 100 != 0) || y % 400 == 0;
+    }
+
+    // Local (wall clock) seconds since the epoch at which a rule fires in year y
+    static int64_t ruleLocalTime(const RuleDate& rule, int64_t y) {
+        int64_t jan1 = daysFromCivil(y, 1, 1);
+        int64_t day;
+        switch (rule.kind) {
+        case RuleDate::JULIAN:
+            // Jn counts 1..365 and never refers to Feb 29
+            day = jan1 + rule.day - 1 + (isLeapYear(y) && rule.day >= 60);
+            break;
+        case RuleDate::ZERO_BASED:
+            day = jan1 + rule.day;
+            break;
+        default: {
+            int64_t first = daysFromCivil(y, rule.month, 1);
+            int first_wday = static_cast<int>(((first + 4) % 7 + 7) % 7); // 1970-01-01 was a Thursday
+            day = first + (rule.day - first_wday + 7) % 7 + (rule.week - 1) * 7;
+            if (rule.week == 5) {
+                static const int month_days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+                int mdays = month_days[rule.month - 1] + (rule.month == 2 && isLeapYear(y));
+                while (day >= first + mdays) day -= 7;
+            }
+            break;
+        }
+        }
+        return day * 86400 + rule.time;
+    }
+
+    const LocalTimeType& footerLookup(int64_t t) const {
+        if (!footer_has_dst) return footer_std;
+
+        int64_t year = yearOf(t + footer_std.utc_offset);
+        // Start is written in standard time, end in daylight time
+        int64_t start = ruleLocalTime(dst_start, year) - footer_std.utc_offset;
+        int64_t end = ruleLocalTime(dst_end, year) - footer_dst.utc_offset;
+
+        bool in_dst = (start < end) ? (t >= start && t < end)   // Northern hemisphere
+                                    : !(t >= end && t < start); // Southern hemisphere
+        return in_dst ? footer_dst : footer_std;
+    }
+};
+
+// Kernel NTP discipline state, as reported by adjtimex
+struct ClockSyncStatus {
+    bool synced = true;
+    long est_error_us = 0;  // Estimated error
+    long max_error_us = 0;  // Upper bound on the error
+};
+
 class SystemTimeManager {
 private:
     struct TimezoneInfo {
@@ -48,86 +468,89 @@ private:
     
     std::vector<TimezoneInfo> tz_cache;
     time_t cache_duration = 3600; // 1 hour cache
+
+    // Parsed zoneinfo files, loaded once per identifier
+    std::map<std::string, std::shared_ptr<const ZoneInfo>> zone_cache;
+
+    // inotify state for system timezone changes
+    int inotify_fd = -1;
+    int etc_wd = -1;
+    int target_wd = -1;
+
+    void watchLocaltimeTarget() {
+        if (target_wd >= 0) {
+            inotify_rm_watch(inotify_fd, target_wd);
+            target_wd = -1;
+        }
+
+        // Follows the symlink, so tzdata upgrades replacing the zone file are seen too
+        char target[PATH_MAX];
+        if (realpath("/etc/localtime", target)) {
+            target_wd = inotify_add_watch(inotify_fd, target,
+                                          IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+        }
+    }
     
 public:
+    ~SystemTimeManager() {
+        if (inotify_fd >= 0) close(inotify_fd);
+    }
+
+    // Drop a parsed zone so the next lookup re-reads it from disk
+    void forgetZoneInfo(const std::string& tz_identifier) {
+        zone_cache.erase(tz_identifier);
+    }
+
+    std::shared_ptr<const ZoneInfo> getZoneInfo(const std::string& tz_identifier) {
+        auto it = zone_cache.find(tz_identifier);
+        if (it != zone_cache.end()) return it->second;
+
+        auto zone = ZoneInfo::load(tz_identifier);
+        if (!zone) {
+            g_print("Warning: could not load zoneinfo for %s\n", tz_identifier.c_str());
+        }
+        zone_cache[tz_identifier] = zone;
+        return zone;
+    }
+
     // Method 3A: Direct system timezone query using /usr/share/zoneinfo
     std::pair<int, bool> getSystemTimezoneOffset(const std::string& tz_identifier) {
-        // Use timedatectl if available (systemd systems)
-        std::string cmd = "TZ='" + tz_identifier + "' date '+%z %Z'";
-        
-        FILE* pipe = popen(cmd.c_str(), "r");
-        if (!pipe) return {0, false};
-        
-        char buffer[256];
-        std::string result = "";
-        while (fgets(buffer, sizeof buffer, pipe) != NULL) {
-            result += buffer;
-        }
-        pclose(pipe);
-        
-        if (result.length() >= 5) {
-            // Parse "+0300 EEST" format
-            int sign = (result[0] == '+') ? 1 : -1;
-            int hours = std::stoi(result.substr(1, 2));
-            int mins = std::stoi(result.substr(3, 2));
-            
-            // Check if DST is active by looking at timezone abbreviation
-            bool is_dst = (result.find("DST") != std::string::npos ||
-                          result.find("EDT") != std::string::npos ||
-                          result.find("PDT") != std::string::npos ||
-                          result.find("MDT") != std::string::npos ||
-                          result.find("CDT") != std::string::npos ||
-                          result.find("EEST") != std::string::npos ||  // Helsinki summer
-                          result.find("CEST") != std::string::npos ||
-                          result.find("BST") != std::string::npos);
-            
-            return {sign * (hours * 3600 + mins * 60), is_dst};
-        }
-        
-        return {0, false};
+        auto zone = getZoneInfo(tz_identifier);
+        if (!zone) return {0, false};
+
+        // DST flag comes straight from the tzdata local time type
+        const auto& type = zone->lookup(time(nullptr));
+        return {type.utc_offset, type.is_dst};
     }
     
-    // Method 3B: Use system's localtime_r with timezone switching
+    // Method 3B: Convert the current time using the zone's own tables
     time_t getTimezoneTime(const std::string& tz_identifier, struct tm* result_tm) {
-        // Save current timezone
-        const char* old_tz = getenv("TZ");
-        
-        // Set target timezone
-        setenv("TZ", tz_identifier.c_str(), 1);
-        tzset();
-        
-        // Get current UTC time
         time_t utc_now = time(nullptr);
-        
-        // Convert to local time in target timezone
-        localtime_r(&utc_now, result_tm);
-        
-        // Restore original timezone
-        if (old_tz) {
-            setenv("TZ", old_tz, 1);
+
+        auto zone = getZoneInfo(tz_identifier);
+        if (zone) {
+            zone->localTime(utc_now, result_tm);
         } else {
-            unsetenv("TZ");
+            gmtime_r(&utc_now, result_tm);
         }
-        tzset();
-        
+
         return utc_now;
     }
     
-    // Method 3C: NTP-style time sync check (ensures system time is accurate)
-    bool checkSystemTimeSync() {
-        // Check if systemd-timesyncd or ntpd is running and synced
-        FILE* pipe = popen("timedatectl status | grep -E '(NTP synchronized|System clock synchronized)'", "r");
-        if (!pipe) return true; // Assume synced if can't check
-        
-        char buffer[256];
-        std::string result = "";
-        while (fgets(buffer, sizeof buffer, pipe) != NULL) {
-            result += buffer;
-        }
-        pclose(pipe);
-        
-        // Check for either "NTP synchronized: yes" or "System clock synchronized: yes"
-        return (result.find("yes") != std::string::npos);
+    // Method 3C: Kernel clock discipline state via ntp_adjtime (no subprocess).
+    // Works the same whether timesyncd, chrony or ntpd is in charge; on
+    // RTC-only systems it simply reports unsynchronised with a growing maxerror.
+    ClockSyncStatus checkSystemTimeSync() {
+        ClockSyncStatus status;
+
+        struct timex tx = {};  // modes = 0: read only
+        int state = ntp_adjtime(&tx);
+        if (state == -1) return status; // Assume synced if can't check
+
+        status.synced = state != TIME_ERROR && !(tx.status & STA_UNSYNC);
+        status.est_error_us = tx.esterror;
+        status.max_error_us = tx.maxerror;
+        return status;
     }
     
     // Method 3D: Get timezone info directly from /etc/localtime and zoneinfo
@@ -171,195 +594,1556 @@ public:
         
         return "UTC"; // Fallback
     }
-};
 
-struct TimeZone {
-    std::string name;
-    std::string status;
-    std::string tz_identifier;
-    int utc_offset_seconds;
-    bool is_dst;
-    int relative_hours;
-    int relative_mins;
-    time_t last_updated;
+    // Method 3E: Watch /etc/localtime, /etc/timezone and the zoneinfo file the
+    // symlink points at. Returns an fd that becomes readable on changes.
+    int startTimezoneWatch() {
+        inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (inotify_fd < 0) return -1;
+
+        // Tools replace these files by rename/symlink, so watch the directory
+        etc_wd = inotify_add_watch(inotify_fd, "/etc",
+                                   IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_ATTRIB);
+        watchLocaltimeTarget();
+        return inotify_fd;
+    }
+
+    // Drain pending events; true if any of them concerns the system timezone
+    bool readTimezoneEvents() {
+        alignas(struct inotify_event) char buffer[4096];
+        bool changed = false;
+
+        ssize_t len;
+        while ((len = read(inotify_fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p = buffer; p < buffer + len; ) {
+                auto* event = reinterpret_cast<struct inotify_event*>(p);
+                p += sizeof(struct inotify_event) + event->len;
+
+                if (event->wd == etc_wd && event->len > 0) {
+                    if (strcmp(event->name, "localtime") == 0 || strcmp(event->name, "timezone") == 0) {
+                        changed = true;
+                    }
+                } else if (event->wd == target_wd) {
+                    changed = true;
+                }
+            }
+        }
+
+        // The link may now point elsewhere, or the old target inode is gone
+        if (changed) watchLocaltimeTarget();
+        return changed;
+    }
 };
 
-class MultiClockWidget {
+// ---------------- SNTP ----------------
+// Minimal SNTP (RFC 4330) client: polls one server over UDP and keeps a
+// filtered estimate of how far, and how fast, the local clock is drifting.
+class SntpClient {
 private:
-    GtkWidget *window;
-    std::vector<TimeZone> timezones;
-    SystemTimeManager time_mgr;
-    std::string user_timezone;
-    int user_utc_offset = 0;
-    time_t last_tz_update = 0;
-    
-    void updateTimezoneData() {
-        time_t now = time(nullptr);
-        
-        // Update every 15 minutes (to catch DST changes quickly)
-        if (now - last_tz_update < 900 && last_tz_update != 0) {
-            return;
+    struct Sample {
+        double local_time;  // System time the reply arrived
+        double offset;      // Server minus local, seconds
+        double delay;       // Round trip, seconds
+    };
+
+    static constexpr double NTP_UNIX_EPOCH_DELTA = 2208988800.0; // 1900 -> 1970
+    static const size_t FILTER_SIZE = 8;    // Replies considered for the min-delay pick
+    static const size_t HISTORY_SIZE = 16;  // Filtered offsets used for the drift fit
+    static constexpr double MAX_DRIFT = 500e-6;
+
+    int sock = -1;
+    double request_sent = 0;
+    uint32_t request_stamp[2] = {0, 0};
+    bool awaiting_reply = false;
+
+    std::vector<Sample> recent;
+    std::vector<std::pair<double, double>> history; // (local time, filtered offset)
+
+    double ref_time = 0;
+    double ref_offset = 0;
+    double drift = 0;
+    bool has_estimate = false;
+
+    static double nowSeconds() {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return ts.tv_sec + ts.tv_nsec / 1e9;
+    }
+
+    // NTP 32.32 fixed point to Unix seconds, picking the 2^32 era nearest local time
+    static double fromNtp(const unsigned char* p, double near) {
+        uint32_t secs = (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+        uint32_t frac = (uint32_t)p[4] << 24 | (uint32_t)p[5] << 16 | (uint32_t)p[6] << 8 | p[7];
+        double t = secs - NTP_UNIX_EPOCH_DELTA + frac / 4294967296.0;
+        const double era = 4294967296.0;
+        while (t < near - era / 2) t += era;
+        while (t > near + era / 2) t -= era;
+        return t;
+    }
+
+    void updateEstimate() {
+        // Clock filter: the reply with the shortest round trip is the least skewed
+        const Sample* best = &recent[0];
+        for (const auto& sample : recent) {
+            if (sample.delay < best->delay) best = &sample;
         }
-        
-        last_tz_update = now;
-        
-        // Ensure system time is synced with NTP
-        if (!time_mgr.checkSystemTimeSync()) {
-            g_print("Warning: System time may not be NTP synchronized\n");
+
+        if (history.empty() || history.back().first != best->local_time) {
+            history.push_back({best->local_time, best->offset});
+            if (history.size() > HISTORY_SIZE) history.erase(history.begin());
         }
-        
-        // Get user's current timezone and offset
-        user_timezone = time_mgr.getCurrentSystemTimezone();
-        auto user_info = time_mgr.getSystemTimezoneOffset(user_timezone);
-        user_utc_offset = user_info.first;
-        
-        // Update all configured timezones
-        for (auto& tz : timezones) {
-            auto info = time_mgr.getSystemTimezoneOffset(tz.tz_identifier);
-            tz.utc_offset_seconds = info.first;
-            tz.is_dst = info.second;
-            
-            // Calculate relative offset from user's current timezone
-            int diff_seconds = tz.utc_offset_seconds - user_utc_offset;
-            tz.relative_hours = diff_seconds / 3600;
-            tz.relative_mins = (diff_seconds % 3600) / 60;
-            
-            tz.last_updated = now;
-            
-            // Debug output
-            g_print("Updated %s: UTC%+d:%02d (DST: %s)\n", 
-                   tz.name.c_str(), 
-                   tz.utc_offset_seconds / 3600,
-                   abs(tz.utc_offset_seconds % 3600) / 60,
-                   tz.is_dst ? "Yes" : "No");
+
+        // Least-squares slope of offset over time is the drift rate
+        drift = 0;
+        if (history.size() >= 2 && history.back().first - history.front().first >= 1.0) {
+            double t0 = history.front().first;
+            double mean_t = 0, mean_o = 0;
+            for (const auto& h : history) {
+                mean_t += h.first - t0;
+                mean_o += h.second;
+            }
+            mean_t /= history.size();
+            mean_o /= history.size();
+
+            double num = 0, den = 0;
+            for (const auto& h : history) {
+                double dt = h.first - t0 - mean_t;
+                num += dt * (h.second - mean_o);
+                den += dt * dt;
+            }
+            if (den > 0) drift = std::max(-MAX_DRIFT, std::min(MAX_DRIFT, num / den));
         }
+
+        ref_time = best->local_time;
+        ref_offset = best->offset;
+        has_estimate = true;
     }
 
 public:
-    MultiClockWidget() {
-        // Initialize timezones from config
-        int config_count = sizeof(TIMEZONE_CONFIGS) / sizeof(TIMEZONE_CONFIGS[0]);
-        for (int i = 0; i < config_count && i < 4; i++) {
-            const auto& config = TIMEZONE_CONFIGS[i];
-            
-            TimeZone tz;
-            tz.name = config.name;
-            tz.status = config.status;
-            tz.tz_identifier = config.tz_identifier;
-            tz.utc_offset_seconds = 0;
-            tz.is_dst = false;
-            tz.relative_hours = 0;
-            tz.relative_mins = 0;
-            tz.last_updated = 0;
-            
-            timezones.push_back(tz);
+    ~SntpClient() {
+        if (sock >= 0) close(sock);
+    }
+
+    // Split "host" or "host:port" (a number or a service name); false for an unknown port
+    static bool splitServer(const std::string& server, std::string& host, uint16_t& port) {
+        host = server;
+        port = 123;
+        size_t colon = server.rfind(':');
+        if (colon == std::string::npos || server.find(':') != colon) return true;
+
+        host = server.substr(0, colon);
+        std::string service = server.substr(colon + 1);
+        char* end = nullptr;
+        long number = strtol(service.c_str(), &end, 10);
+        if (!service.empty() && *end == '\0') {
+            port = (uint16_t)number;
+            return number > 0 && number <= 65535;
         }
-        
-        // Initial timezone data update
-        updateTimezoneData();
+        struct servent* entry = getservbyname(service.c_str(), "udp");
+        if (entry) port = ntohs(entry->s_port);
+        return entry != nullptr;
+    }
 
-        gtk_init(nullptr, nullptr);
+    // Connect the UDP socket to a resolved server address; returns the fd to poll, or -1
+    int start(const struct sockaddr* address, socklen_t length) {
+        sock = socket(address->sa_family, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (sock < 0) return -1;
+        if (connect(sock, address, length) != 0) {
+            close(sock);
+            sock = -1;
+        }
+        return sock;
+    }
 
-        window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
-        gtk_window_set_decorated(GTK_WINDOW(window), FALSE);
-        gtk_window_set_resizable(GTK_WINDOW(window), FALSE);
-        gtk_widget_set_app_paintable(window, TRUE);
+    void sendRequest() {
+        if (sock < 0) return;
 
-        gtk_window_set_skip_taskbar_hint(GTK_WINDOW(window), TRUE);
-        gtk_window_set_skip_pager_hint(GTK_WINDOW(window), TRUE);
+        unsigned char packet[48] = {};
+        packet[0] = (0 << 6) | (4 << 3) | 3; // LI 0, version 4, mode 3 (client)
 
-        g_signal_connect(window, "screen-changed", G_CALLBACK(on_screen_changed), nullptr);
-        g_signal_connect(window, "draw", G_CALLBACK(on_draw), this);
-        g_signal_connect(window, "button-press-event", G_CALLBACK(on_button_press), nullptr);
-        g_signal_connect(window, "destroy", G_CALLBACK(gtk_main_quit), nullptr);
+        // The server echoes our transmit stamp back as its originate stamp
+        request_sent = nowSeconds();
+        double ntp_time = request_sent + NTP_UNIX_EPOCH_DELTA;
+        request_stamp[0] = (uint32_t)ntp_time;
+        request_stamp[1] = (uint32_t)((ntp_time - floor(ntp_time)) * 4294967296.0);
+        for (int i = 0; i < 4; i++) {
+            packet[40 + i] = request_stamp[0] >> (24 - 8 * i);
+            packet[44 + i] = request_stamp[1] >> (24 - 8 * i);
+        }
 
-        gtk_widget_add_events(window, GDK_BUTTON_PRESS_MASK);
+        if (send(sock, packet, sizeof(packet), 0) == sizeof(packet)) {
+            awaiting_reply = true;
+        }
+    }
 
-        int width = 520;
-        int height = 160;
-        gtk_window_set_default_size(GTK_WINDOW(window), width, height);
-        
-        int x = SCREEN_WIDTH - width - RIGHT_MARGIN;
-        int y = TOP_MARGIN;
-        gtk_window_move(GTK_WINDOW(window), x, y);
+    // Consume pending replies; true if the estimate changed
+    bool readResponse() {
+        bool updated = false;
+        unsigned char packet[68];
+        ssize_t len;
+        while ((len = recv(sock, packet, sizeof(packet), 0)) >= 0) {
+            double received = nowSeconds();
+            if (len < 48 || !awaiting_reply) continue;
 
-        gtk_widget_show_all(window);
+            int leap = packet[0] >> 6;
+            int mode = packet[0] & 0x7;
+            int stratum = packet[1];
+            if (leap == 3 || mode != 4 || stratum == 0 || stratum > 15) continue;
 
-        // Update display every second
-        g_timeout_add(1000, (GSourceFunc)update_time, this);
-        // Check for timezone changes every 15 minutes
-        g_timeout_add(900000, (GSourceFunc)update_timezones, this);
+            // Originate timestamp must match what we sent
+            uint32_t orig[2] = {0, 0};
+            for (int i = 0; i < 4; i++) {
+                orig[0] = (orig[0] << 8) | packet[24 + i];
+                orig[1] = (orig[1] << 8) | packet[28 + i];
+            }
+            if (orig[0] != request_stamp[0] || orig[1] != request_stamp[1]) continue;
+            awaiting_reply = false;
+
+            double t1 = request_sent;
+            double t2 = fromNtp(packet + 32, received);
+            double t3 = fromNtp(packet + 40, received);
+            double t4 = received;
+
+            Sample sample;
+            sample.local_time = t4;
+            sample.offset = ((t2 - t1) + (t3 - t4)) / 2;
+            sample.delay = std::max(0.0, (t4 - t1) - (t3 - t2));
+
+            recent.push_back(sample);
+            if (recent.size() > FILTER_SIZE) recent.erase(recent.begin());
+            updateEstimate();
+            updated = true;
+        }
+        return updated;
+    }
+
+    // Seconds to add to the system clock at system time `now`
+    double correction(double now) const {
+        if (!has_estimate) return 0;
+        return ref_offset + drift * (now - ref_time);
+    }
+
+    double driftPpm() const { return drift * 1e6; }
+    bool hasEstimate() const { return has_estimate; }
+};
+
+struct TimeZone {
+    std::string name;
+    std::string status;
+    std::string tz_identifier;
+    int utc_offset_seconds;
+    bool is_dst;
+    int relative_hours;
+    int relative_mins;
+    time_t last_updated;
+    std::shared_ptr<const ZoneInfo> zone;  // Immutable, safe to read from any thread
+};
+
+// ---------------- ZONE SEARCH ----------------
+// Searchable list of every zone in zone1970.tab and zone.tab, with country
+// names from iso3166.tab and old city names from tzdata.zi links as aliases.
+// Built on the first search, so startup never reads the tables.
+class ZoneSearchIndex {
+public:
+    struct Entry {
+        std::string tz_identifier;  // "America/Argentina/Buenos_Aires"
+        std::string city;           // "Buenos Aires"
+        std::string country;        // "Argentina", or several joined with ", "
+        std::string comment;        // zone1970.tab comment, e.g. "most areas"
+        std::string text;           // Normalized city, region, countries, aliases and comment
+        std::string city_key;       // Normalized city
+    };
+
+    struct Match {
+        const Entry *entry;
+        int score;
+    };
+
+    // Ranked matches for a partially typed query, best first
+    std::vector<Match> search(const std::string &query, size_t limit) {
+        if (!built) build();
+
+        std::string q = normalize(query);
+        std::vector<Match> matches;
+        if (q.empty()) return matches;
+
+        std::vector<std::string> words;
+        std::istringstream split(q);
+        for (std::string word; split >> word && words.size() < 32;) words.push_back(word);
+
+        // Prefix pass: which query words start a token of each entry, and the
+        // weakest field any word needed (city beats country beats comment)
+        const uint32_t all_words = words.size() == 32 ? UINT32_MAX : (1u << words.size()) - 1;
+        std::vector<uint32_t> word_mask(entries.size(), 0);
+        std::vector<std::vector<uint8_t>> word_weight(words.size());
+        for (size_t i = 0; i < words.size(); i++) {
+            word_weight[i].assign(entries.size(), 0);
+            auto it = std::lower_bound(tokens.begin(), tokens.end(), words[i],
+                                       [](const Token &token, const std::string &word) { return token.text < word; });
+            for (; it != tokens.end() && it->text.compare(0, words[i].size(), words[i]) == 0; ++it) {
+                word_mask[it->entry] |= 1u << i;
+                word_weight[i][it->entry] = std::max(word_weight[i][it->entry], it->weight);
+            }
+        }
+
+        // Trigram pass for typos and mid-word fragments
+        std::vector<uint16_t> trigram_hits(entries.size(), 0);
+        std::vector<uint32_t> query_trigrams;
+        for (size_t i = 0; i + 3 <= q.size(); i++) query_trigrams.push_back(trigram_key(q, i));
+        std::sort(query_trigrams.begin(), query_trigrams.end());
+        query_trigrams.erase(std::unique(query_trigrams.begin(), query_trigrams.end()), query_trigrams.end());
+        for (uint32_t key : query_trigrams) {
+            auto it = trigrams.find(key);
+            if (it == trigrams.end()) continue;
+            for (uint16_t entry : it->second) trigram_hits[entry]++;
+        }
+
+        for (size_t e = 0; e < entries.size(); e++) {
+            const Entry &entry = entries[e];
+            int score = 0;
+            if (word_mask[e] == all_words) {
+                int weakest = WEIGHT_CITY;
+                for (size_t i = 0; i < words.size(); i++) weakest = std::min<int>(weakest, word_weight[i][e]);
+                score = 600 + 40 * weakest;
+                if (entry.city_key == q) score += 300;
+                else if (entry.city_key.compare(0, q.size(), q) == 0) score += 150;
+            } else if (!query_trigrams.empty()) {
+                double fraction = (double)trigram_hits[e] / query_trigrams.size();
+                if (fraction >= 0.5) score = (int)(400 * fraction);
+            }
+            if (score > 0) matches.push_back({&entry, score});
+        }
+
+        auto better = [](const Match &a, const Match &b) {
+            if (a.score != b.score) return a.score > b.score;
+            if (a.entry->city.size() != b.entry->city.size()) return a.entry->city.size() < b.entry->city.size();
+            return a.entry->tz_identifier < b.entry->tz_identifier;
+        };
+        size_t keep = std::min(limit, matches.size());
+        std::partial_sort(matches.begin(), matches.begin() + keep, matches.end(), better);
+        matches.resize(keep);
+        return matches;
+    }
+
+    size_t size() {
+        if (!built) build();
+        return entries.size();
+    }
+
+private:
+    enum : uint8_t { WEIGHT_COMMENT = 1, WEIGHT_COUNTRY = 2, WEIGHT_REGION = 2, WEIGHT_CITY = 3 };
+
+    struct Token {
+        std::string text;
+        uint16_t entry;
+        uint8_t weight;
+    };
+
+    bool built = false;
+    std::vector<Entry> entries;
+    std::vector<Token> tokens;  // Sorted by text for prefix lookups
+    std::map<uint32_t, std::vector<uint16_t>> trigrams;  // Entries containing each trigram
+
+    // Lowercase ASCII, punctuation to single spaces
+    static std::string normalize(const std::string &text) {
+        std::string out;
+        for (unsigned char c : text) {
+            if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
+            bool keep = (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80;
+            if (keep) {
+                out += (char)c;
+            } else if (!out.empty() && out.back() != ' ') {
+                out += ' ';
+            }
+        }
+        if (!out.empty() && out.back() == ' ') out.pop_back();
+        return out;
+    }
+
+    static uint32_t trigram_key(const std::string &text, size_t i) {
+        return (uint32_t)(unsigned char)text[i] << 16 | (uint32_t)(unsigned char)text[i + 1] << 8 |
+               (unsigned char)text[i + 2];
+    }
+
+    static std::string city_of(const std::string &tz_identifier) {
+        std::string city = tz_identifier.substr(tz_identifier.rfind('/') + 1);
+        std::replace(city.begin(), city.end(), '_', ' ');
+        return city;
+    }
+
+    static std::vector<std::string> split_tab(const std::string &line) {
+        std::vector<std::string> fields;
+        std::istringstream in(line);
+        for (std::string field; std::getline(in, field, '\t');) fields.push_back(field);
+        return fields;
+    }
+
+    void add_tokens(uint16_t entry, const std::string &text, uint8_t weight) {
+        std::istringstream split(normalize(text));
+        for (std::string word; split >> word;) tokens.push_back({word, entry, weight});
+    }
+
+    void build() {
+        built = true;
+        const char *tzdir = getenv("TZDIR");
+        std::string dir = tzdir ? tzdir : "/usr/share/zoneinfo";
+
+        std::map<std::string, std::string> countries;
+        std::ifstream iso(dir + "/iso3166.tab");
+        for (std::string line; std::getline(iso, line);) {
+            if (line.empty() || line[0] == '#') continue;
+            auto fields = split_tab(line);
+            if (fields.size() >= 2) countries[fields[0]] = fields[1];
+        }
+
+        // zone1970.tab first (comments, multi-country zones), then anything only zone.tab lists
+        std::map<std::string, size_t> by_identifier;
+        for (const char *table : {"/zone1970.tab", "/zone.tab"}) {
+            std::ifstream tab(dir + table);
+            for (std::string line; std::getline(tab, line);) {
+                if (line.empty() || line[0] == '#') continue;
+                auto fields = split_tab(line);
+                if (fields.size() < 3 || by_identifier.count(fields[2])) continue;
+
+                Entry entry;
+                entry.tz_identifier = fields[2];
+                entry.city = city_of(entry.tz_identifier);
+                if (fields.size() > 3) entry.comment = fields[3];
+                std::istringstream codes(fields[0]);
+                for (std::string code; std::getline(codes, code, ',');) {
+                    auto it = countries.find(code);
+                    if (it == countries.end()) continue;
+                    if (!entry.country.empty()) entry.country += ", ";
+                    entry.country += it->second;
+                }
+                by_identifier[entry.tz_identifier] = entries.size();
+                entries.push_back(entry);
+            }
+        }
+
+        // Link names ("L Asia/Kolkata Asia/Calcutta") make old city names findable
+        std::map<size_t, std::string> aliases;
+        std::ifstream zi(dir + "/tzdata.zi");
+        for (std::string line; std::getline(zi, line);) {
+            if (line.compare(0, 2, "L ") != 0) continue;
+            std::istringstream fields(line.substr(2));
+            std::string target, link;
+            fields >> target >> link;
+            auto it = by_identifier.find(target);
+            if (it == by_identifier.end() || link.find('/') == std::string::npos) continue;
+            aliases[it->second] += " " + city_of(link);
+        }
+
+        for (size_t e = 0; e < entries.size(); e++) {
+            Entry &entry = entries[e];
+            std::string region = entry.tz_identifier.substr(0, entry.tz_identifier.rfind('/'));
+            add_tokens(e, entry.city, WEIGHT_CITY);
+            add_tokens(e, aliases[e], WEIGHT_CITY);
+            add_tokens(e, region, WEIGHT_REGION);
+            add_tokens(e, entry.country, WEIGHT_COUNTRY);
+            add_tokens(e, entry.comment, WEIGHT_COMMENT);
+
+            entry.city_key = normalize(entry.city);
+            entry.text = normalize(entry.city + " " + aliases[e] + " " + region + " " +
+                                   entry.country + " " + entry.comment);
+            std::vector<uint32_t> keys;
+            for (size_t i = 0; i + 3 <= entry.text.size(); i++) keys.push_back(trigram_key(entry.text, i));
+            std::sort(keys.begin(), keys.end());
+            keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+            for (uint32_t key : keys) trigrams[key].push_back((uint16_t)e);
+        }
+
+        std::sort(tokens.begin(), tokens.end(),
+                  [](const Token &a, const Token &b) { return a.text < b.text; });
+    }
+};
+
+// ---------------- TEXT CACHE ----------------
+// Font descriptions shared across frames, keyed by pixel size and weight,
+// plus one Pango context for every cached layout. Layouts are only
+// re-shaped when their text actually changes.
+class TextCache {
+private:
+    PangoContext *context = nullptr;
+    std::map<std::pair<int, int>, PangoFontDescription*> fonts;
+
+public:
+    ~TextCache() {
+        for (auto& font : fonts) pango_font_description_free(font.second);
+        if (context) g_object_unref(context);
+    }
+
+    const PangoFontDescription *font(int pixel_size, PangoWeight weight) {
+        auto key = std::make_pair(pixel_size, (int)weight);
+        auto it = fonts.find(key);
+        if (it != fonts.end()) return it->second;
+
+        PangoFontDescription *desc = pango_font_description_new();
+        pango_font_description_set_family(desc, "SF Pro Display");
+        pango_font_description_set_weight(desc, weight);
+        pango_font_description_set_absolute_size(desc, pixel_size * PANGO_SCALE);
+        fonts[key] = desc;
+        return desc;
+    }
+
+    // New layout on the shared context with the given font
+    PangoLayout *layout(cairo_t *cr, int pixel_size, PangoWeight weight) {
+        if (!context) context = pango_cairo_create_context(cr);
+        PangoLayout *layout = pango_layout_new(context);
+        pango_layout_set_font_description(layout, font(pixel_size, weight));
+        return layout;
+    }
+
+    // Set text only if it differs, so unchanged strings keep their shaping
+    static void set_text(PangoLayout *layout, const std::string &text) {
+        const char *current = pango_layout_get_text(layout);
+        if (current && text == current) return;
+        pango_layout_set_text(layout, text.c_str(), -1);
+    }
+};
+
+// Pre-rendered face, ring and hour markers, shared by every clock of the same look and size
+struct DialFace {
+    cairo_surface_t *surface = nullptr;
+    bool is_day = false;
+    bool is_dst = false;
+    int width = 0;
+    int height = 0;
+};
+
+// Every position of each hand, pre-rendered with its shadow and packed into one surface.
+// Shared by every clock with the same radius and day/night look.
+struct HandAtlas {
+    struct Sprite {
+        int atlas_x, atlas_y;  // Top-left in the atlas
+        int dx, dy;            // Top-left relative to the clock center
+        int width, height;
+    };
+
+    cairo_surface_t *surface = nullptr;
+    int radius = 0;
+    bool is_day = false;
+    std::vector<Sprite> hour;    // 720: one per minute of the half-day
+    std::vector<Sprite> minute;  // 60
+    std::vector<Sprite> second;  // 60
+};
+
+// Per-clock cache: the look it was last drawn with and its pre-rendered labels
+struct ClockFace {
+    cairo_surface_t *labels = nullptr;
+    int labels_y = 0;  // Top of the label band within the cell
+    std::string tz_identifier;
+    bool is_day = false;
+    bool is_dst = false;
+    int width = 0;
+    int height = 0;
+    int relative_offset = 0;
+
+    // Shaped label text, kept across frames
+    PangoLayout *city_layout = nullptr;
+    PangoLayout *status_layout = nullptr;
+    PangoLayout *offset_layout = nullptr;
+
+    // Hour and minute hands, cached while the second hand sweeps
+    cairo_surface_t *hands = nullptr;
+    GdkRectangle hands_rect = {0, 0, 0, 0};
+    int hands_minute_of_day = -1;
+    bool hands_is_day = false;
+};
+
+class MultiClockWidget {
+private:
+    GtkWidget *window = nullptr;
+    std::vector<TimeZone> timezones;
+    std::vector<ClockFace> faces;
+    std::vector<DialFace> dials;
+    std::vector<HandAtlas> hand_atlases;
+    bool hand_sprites = HAND_SPRITES;
+    TextCache text_cache;
+    PangoLayout *sync_layout = nullptr;
+    std::vector<GdkRectangle> drawn_hands;  // Area each clock's hands covered when last queued
+    bool debug_damage = false;
+    int debug_tint = 0;  // Advances every tick, so fresh damage stands out from older tint
+    bool headless = false;  // Offscreen rendering only (benchmarks): no window, no timers
+    SystemTimeManager time_mgr;
+    std::string user_timezone;
+    int user_utc_offset = 0;
+    time_t last_tz_update = 0;
+    int tick_fd = -1;
+    int transition_fd = -1;
+    guint tz_settle_source = 0;
+
+    // Clock discipline state, refreshed from adjtimex
+    ClockSyncStatus sync_status;
+    std::string sync_label;
+    time_t last_sync_check = 0;
+    static const int SYNC_LABEL_WIDTH = 80;
+    static const int SYNC_LABEL_HEIGHT = 14;
+
+    // Optional SNTP correction applied to the drawn time; set once the server resolves
+    std::unique_ptr<SntpClient> sntp;
+    std::string sntp_server;
+    uint16_t sntp_port = 123;
+
+    // Sweep mode: frame-clock driven second hand with a draw-time budget
+    bool sweep_active = false;
+    guint sweep_tick_id = 0;
+    gint64 last_sweep_frame = 0;
+    double sweep_draw_ms = 0;  // Moving average of on_draw time
+    int sweep_frames = 0;
+    std::vector<GdkRectangle> drawn_sweep;  // Second hand area per clock when last queued
+
+    // Right-click "add clock" picker; the zone index is only built when it first opens
+    std::unique_ptr<ZoneSearchIndex> zone_index;
+    GtkWidget *picker = nullptr;
+    GtkWidget *picker_entry = nullptr;
+    GtkWidget *picker_list = nullptr;
+    GtkCssProvider *picker_css = nullptr;  // Providers do not cascade: rows get it as they are made
+    std::vector<const ZoneSearchIndex::Entry*> picker_results;
+    static const int PICKER_WIDTH = 300;
+    static const size_t PICKER_RESULTS = 8;
+    
+    void updateTimezoneData() {
+        time_t now = time(nullptr);
+        last_tz_update = now;
+        
+        // Ensure system time is synced with NTP
+        refresh_sync_status();
+        
+        // Get user's current offset; the timezone itself is tracked by the inotify watch
+        if (user_timezone.empty()) {
+            user_timezone = time_mgr.getCurrentSystemTimezone();
+        }
+        auto user_info = time_mgr.getSystemTimezoneOffset(user_timezone);
+        user_utc_offset = user_info.first;
+        
+        // Update all configured timezones
+        for (auto& tz : timezones) {
+            tz.zone = time_mgr.getZoneInfo(tz.tz_identifier);
+            auto info = time_mgr.getSystemTimezoneOffset(tz.tz_identifier);
+            tz.utc_offset_seconds = info.first;
+            tz.is_dst = info.second;
+            
+            // Calculate relative offset from user's current timezone
+            int diff_seconds = tz.utc_offset_seconds - user_utc_offset;
+            tz.relative_hours = diff_seconds / 3600;
+            tz.relative_mins = (diff_seconds % 3600) / 60;
+            
+            tz.last_updated = now;
+            
+            // Debug output
+            if (!headless) {
+                g_print("Updated %s: UTC%+d:%02d (DST: %s)\n", 
+                       tz.name.c_str(), 
+                       tz.utc_offset_seconds / 3600,
+                       abs(tz.utc_offset_seconds % 3600) / 60,
+                       tz.is_dst ? "Yes" : "No");
+            }
+        }
+
+        arm_transition_timer();
+    }
+
+    // One-shot wakeup at the earliest upcoming offset/DST change of any shown zone
+    void arm_transition_timer() {
+        if (headless) return;
+
+        time_t now = time(nullptr);
+        int64_t next = INT64_MAX;
+
+        auto user_zone = time_mgr.getZoneInfo(user_timezone);
+        if (user_zone) next = user_zone->nextTransition(now);
+        for (const auto& tz : timezones) {
+            if (tz.zone) next = std::min(next, tz.zone->nextTransition(now));
+        }
+
+        if (transition_fd < 0) {
+            transition_fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+            if (transition_fd < 0) return;
+            g_unix_fd_add(transition_fd, G_IO_IN, on_transition, this);
+        }
+
+        // A zero it_value disarms the timer when nothing is scheduled
+        struct itimerspec spec = {};
+        if (next != INT64_MAX && next <= (int64_t)std::numeric_limits<time_t>::max()) {
+            spec.it_value.tv_sec = (time_t)next;
+        }
+        timerfd_settime(transition_fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr);
+    }
+
+    void start_timezone_watch() {
+        int fd = time_mgr.startTimezoneWatch();
+        if (fd < 0) {
+            g_print("Warning: inotify unavailable, system timezone changes will not be picked up\n");
+            return;
+        }
+        g_unix_fd_add(fd, G_IO_IN, on_timezone_event, this);
+    }
+
+    static gboolean on_timezone_event(gint fd, GIOCondition condition, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+
+        // timedatectl and package upgrades touch several files in a row;
+        // settle once the burst is over
+        if (self->time_mgr.readTimezoneEvents() && self->tz_settle_source == 0) {
+            self->tz_settle_source = g_timeout_add(250, (GSourceFunc)on_timezone_settled, self);
+        }
+        return G_SOURCE_CONTINUE;
+    }
+
+    static gboolean on_timezone_settled(gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        self->tz_settle_source = 0;
+
+        std::string old_timezone = self->user_timezone;
+        int old_offset = self->user_utc_offset;
+
+        // The zone files may have been replaced by a tzdata upgrade, the
+        // shown zones' as well as the system one
+        self->time_mgr.forgetZoneInfo(old_timezone);
+        for (const auto& tz : self->timezones) self->time_mgr.forgetZoneInfo(tz.tz_identifier);
+        std::string new_timezone = self->time_mgr.getCurrentSystemTimezone();
+        self->time_mgr.forgetZoneInfo(new_timezone);
+
+        int new_offset = self->time_mgr.getSystemTimezoneOffset(new_timezone).first;
+        bool changed = new_timezone != old_timezone || new_offset != old_offset;
+        if (changed) {
+            g_print("System timezone changed: %s -> %s\n", old_timezone.c_str(), new_timezone.c_str());
+        }
+
+        // Reload the rules and re-arm the transition timer even when nothing
+        // moved; redraw only if some clock's offset did
+        std::vector<std::pair<int, bool>> old_offsets;
+        for (const auto& tz : self->timezones) old_offsets.push_back({tz.utc_offset_seconds, tz.is_dst});
+        self->user_timezone = new_timezone;
+        self->updateTimezoneData();
+        for (size_t i = 0; i < self->timezones.size() && !changed; i++) {
+            const auto& tz = self->timezones[i];
+            changed = old_offsets[i] != std::make_pair(tz.utc_offset_seconds, tz.is_dst);
+        }
+        if (changed && self->window) gtk_widget_queue_draw(self->window);
+        return G_SOURCE_REMOVE;
+    }
+
+    static gboolean on_transition(gint fd, GIOCondition condition, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+
+        uint64_t expirations;
+        if (read(fd, &expirations, sizeof(expirations)) < 0 && errno == EAGAIN) {
+            return G_SOURCE_CONTINUE;
+        }
+
+        // Fired at the transition instant, or the clock was stepped (ECANCELED):
+        // either way recompute offsets and schedule the following transition
+        self->updateTimezoneData();
+        if (self->window) gtk_widget_queue_draw(self->window);
+        return G_SOURCE_CONTINUE;
+    }
+
+public:
+    MultiClockWidget() {
+        // Initialize timezones from config
+        for (const auto& config : TIMEZONE_CONFIGS) {
+            add_timezone(config);
+        }
+        
+        // Initial timezone data update
+        updateTimezoneData();
+
+        // CLOCK_DEBUG_DAMAGE=1 tints every repainted rectangle, in a new color each tick
+        debug_damage = getenv("CLOCK_DEBUG_DAMAGE") != nullptr;
+
+        gtk_init(nullptr, nullptr);
+
+        window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        gtk_window_set_decorated(GTK_WINDOW(window), FALSE);
+        gtk_window_set_resizable(GTK_WINDOW(window), FALSE);
+        gtk_widget_set_app_paintable(window, TRUE);
+
+        gtk_window_set_skip_taskbar_hint(GTK_WINDOW(window), TRUE);
+        gtk_window_set_skip_pager_hint(GTK_WINDOW(window), TRUE);
+
+        g_signal_connect(window, "screen-changed", G_CALLBACK(on_screen_changed), nullptr);
+        g_signal_connect(window, "draw", G_CALLBACK(on_draw), this);
+        g_signal_connect(window, "button-press-event", G_CALLBACK(on_button_press), this);
+        g_signal_connect(window, "destroy", G_CALLBACK(gtk_main_quit), nullptr);
+
+        gtk_widget_add_events(window, GDK_BUTTON_PRESS_MASK);
+
+        int width, height;
+        window_size(width, height);
+        gtk_window_set_default_size(GTK_WINDOW(window), width, height);
+        
+        int x = SCREEN_WIDTH - width - RIGHT_MARGIN;
+        int y = TOP_MARGIN;
+        gtk_window_move(GTK_WINDOW(window), x, y);
+
+        gtk_widget_show_all(window);
+
+        // Tick on wall-clock second (or minute) boundaries; offsets are
+        // refreshed by the transition timer armed in updateTimezoneData()
+        // and by the system timezone watch
+        start_ticks();
+        start_timezone_watch();
+        start_sntp();
+        if (SWEEP_SECOND_HAND && SHOW_SECOND_HAND) {
+            start_sweep();
+        }
+
+        gtk_main();
+    }
+
+    // Offscreen instance for rendering into any cairo surface via render()
+    explicit MultiClockWidget(const std::vector<TimezoneConfig>& configs) {
+        headless = true;
+        for (const auto& config : configs) {
+            add_timezone(config);
+        }
+        updateTimezoneData();
+    }
+
+    ~MultiClockWidget() {
+        if (tick_fd >= 0) close(tick_fd);
+        if (transition_fd >= 0) close(transition_fd);
+        for (auto& face : faces) {
+            if (face.labels) cairo_surface_destroy(face.labels);
+            if (face.city_layout) g_object_unref(face.city_layout);
+            if (face.status_layout) g_object_unref(face.status_layout);
+            if (face.offset_layout) g_object_unref(face.offset_layout);
+            if (face.hands) cairo_surface_destroy(face.hands);
+        }
+        if (sync_layout) g_object_unref(sync_layout);
+        for (auto& dial : dials) {
+            cairo_surface_destroy(dial.surface);
+        }
+        for (auto& atlas : hand_atlases) {
+            cairo_surface_destroy(atlas.surface);
+        }
+    }
+
+    // Switch between stroked and sprite hands (benchmarks compare the two)
+    void set_hand_sprites(bool enabled) {
+        hand_sprites = enabled;
+    }
+
+    void add_timezone(const TimezoneConfig& config) {
+        TimeZone tz;
+        tz.name = config.name;
+        tz.status = config.status;
+        tz.tz_identifier = config.tz_identifier;
+        tz.utc_offset_seconds = 0;
+        tz.is_dst = false;
+        tz.relative_hours = 0;
+        tz.relative_mins = 0;
+        tz.last_updated = 0;
+
+        // Zones with the same identifier share one parsed ZoneInfo
+        tz.zone = time_mgr.getZoneInfo(tz.tz_identifier);
+        timezones.push_back(tz);
+    }
+
+    void grid_size(int &columns, int &rows) const {
+        int count = std::max(1, (int)timezones.size());
+        columns = std::min(count, CLOCK_COLUMNS);
+        rows = (count + columns - 1) / columns;
+    }
+
+    void window_size(int &width, int &height) const {
+        int columns, rows;
+        grid_size(columns, rows);
+        width = columns * CLOCK_CELL_WIDTH;
+        height = rows * CLOCK_CELL_HEIGHT;
+    }
+
+    static gboolean update_time(gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        self->on_tick_boundary();
+        return TRUE;
+    }
+
+    void start_ticks() {
+        tick_fd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (tick_fd < 0 || !arm_tick_timer()) {
+            g_print("Warning: timerfd unavailable, falling back to a free-running timer\n");
+            if (tick_fd >= 0) close(tick_fd);
+            tick_fd = -1;
+            g_timeout_add(SHOW_SECOND_HAND ? 1000 : 60000, (GSourceFunc)update_time, this);
+            return;
+        }
+        g_unix_fd_add(tick_fd, G_IO_IN, on_tick, this);
+    }
+
+    // Absolute CLOCK_REALTIME timer on the next boundary, repeating every period.
+    // CANCEL_ON_SET makes the fd report ECANCELED when the clock is stepped.
+    bool arm_tick_timer() {
+        const time_t period = SHOW_SECOND_HAND ? 1 : 60;
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+
+        // Boundaries are those of the displayed (SNTP-corrected) time
+        double system_now = now.tv_sec + now.tv_nsec / 1e9;
+        double correction = display_correction(system_now);
+        double boundary = (floor((system_now + correction) / period) + 1) * period - correction;
+
+        struct itimerspec spec = {};
+        spec.it_value.tv_sec = (time_t)floor(boundary);
+        spec.it_value.tv_nsec = (long)((boundary - floor(boundary)) * 1e9);
+        spec.it_interval.tv_sec = period;
+        return timerfd_settime(tick_fd, TFD_TIMER_ABSTIME | TFD_TIMER_CANCEL_ON_SET, &spec, nullptr) == 0;
+    }
+
+    static gboolean on_tick(gint fd, GIOCondition condition, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+
+        uint64_t expirations;
+        if (read(fd, &expirations, sizeof(expirations)) < 0) {
+            if (errno == ECANCELED) {
+                // Wall clock jumped: realign to the new boundaries
+                self->arm_tick_timer();
+            } else if (errno == EAGAIN) {
+                return G_SOURCE_CONTINUE;
+            }
+        }
+
+        self->on_tick_boundary();
+        return G_SOURCE_CONTINUE;
+    }
+
+    // SNTP correction in seconds; zero and free when the feature is off
+    double display_correction(double system_now) const {
+        return sntp ? sntp->correction(system_now) : 0.0;
+    }
+
+    // Sub-second wall-clock time to draw, including the SNTP correction
+    double display_now() const {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        double system_now = now.tv_sec + now.tv_nsec / 1e9;
+        return system_now + display_correction(system_now);
+    }
+
+    // Wall-clock second to draw, including the SNTP correction
+    time_t display_time() const {
+        if (!sntp) return time(nullptr);
+
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        double system_now = now.tv_sec + now.tv_nsec / 1e9;
+        // A hair of slack so a tick landing exactly on the boundary rounds forward
+        return (time_t)floor(system_now + display_correction(system_now) + 1e-3);
+    }
+
+    void start_sntp() {
+        const char* override_server = getenv("CLOCK_NTP_SERVER");
+        std::string server = override_server ? override_server : NTP_SERVER;
+        if (server.empty()) return;
+
+        std::string host;
+        if (!SntpClient::splitServer(server, host, sntp_port)) {
+            g_print("Warning: unknown port in NTP server %s\n", server.c_str());
+            return;
+        }
+        sntp_server = server;
+
+        // Resolved asynchronously: with DNS down, the clocks must not wait for it
+        GResolver *resolver = g_resolver_get_default();
+        g_resolver_lookup_by_name_async(resolver, host.c_str(), nullptr, on_sntp_resolved, this);
+        g_object_unref(resolver);
+    }
+
+    static void on_sntp_resolved(GObject *resolver, GAsyncResult *result, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        GError *error = nullptr;
+        GList *addresses = g_resolver_lookup_by_name_finish(G_RESOLVER(resolver), result, &error);
+        if (!addresses) {
+            g_print("Warning: could not resolve NTP server %s: %s\n", self->sntp_server.c_str(), error->message);
+            g_error_free(error);
+            return;
+        }
+
+        std::unique_ptr<SntpClient> client(new SntpClient());
+        int fd = -1;
+        for (GList *item = addresses; item && fd < 0; item = item->next) {
+            GSocketAddress *address = g_inet_socket_address_new(G_INET_ADDRESS(item->data), self->sntp_port);
+            struct sockaddr_storage native;
+            if (g_socket_address_to_native(address, &native, sizeof(native), nullptr)) {
+                fd = client->start(reinterpret_cast<struct sockaddr*>(&native),
+                                   (socklen_t)g_socket_address_get_native_size(address));
+            }
+            g_object_unref(address);
+        }
+        g_resolver_free_addresses(addresses);
+        if (fd < 0) {
+            // A connected UDP socket says nothing about reachability; only setup failed
+            g_print("Warning: could not set up a socket for NTP server %s\n", self->sntp_server.c_str());
+            return;
+        }
+
+        self->sntp = std::move(client);
+        g_unix_fd_add(fd, G_IO_IN, on_sntp_reply, self);
+        g_timeout_add_seconds(NTP_POLL_SECONDS, (GSourceFunc)on_sntp_poll, self);
+        self->sntp->sendRequest();
+    }
+
+    static gboolean on_sntp_poll(gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        self->sntp->sendRequest();
+        return TRUE;
+    }
+
+    static gboolean on_sntp_reply(gint fd, GIOCondition condition, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        if (self->sntp->readResponse()) {
+            double now = g_get_real_time() / 1e6;
+            g_print("SNTP: clock offset %+.3f ms, drift %+.2f ppm\n",
+                    self->sntp->correction(now) * 1000, self->sntp->driftPpm());
+            // Keep ticks on the corrected second boundaries
+            if (self->tick_fd >= 0) self->arm_tick_timer();
+        }
+        return G_SOURCE_CONTINUE;
+    }
+
+    void start_sweep() {
+        sweep_active = true;
+        sweep_frames = 0;
+        sweep_draw_ms = 0;
+        sweep_tick_id = gtk_widget_add_tick_callback(window, on_frame_tick, this, nullptr);
+    }
+
+    // Draws are over budget: drop back to the 1 Hz tick for the rest of the session
+    void stop_sweep() {
+        g_print("Sweep second hand averaging %.2f ms per frame (budget %.2f ms), falling back to 1 Hz\n",
+                sweep_draw_ms, SWEEP_FRAME_BUDGET_MS);
+        sweep_active = false;
+        if (sweep_tick_id) gtk_widget_remove_tick_callback(window, sweep_tick_id);
+        sweep_tick_id = 0;
+        drawn_hands.clear();
+        drawn_sweep.clear();
+        gtk_widget_queue_draw(window);
+    }
+
+    static gboolean on_frame_tick(GtkWidget *widget, GdkFrameClock *frame_clock, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+
+        // Frame clock runs at the display rate; only draw up to SWEEP_MAX_FPS.
+        // Half a refresh of slack: frame times jitter, and 30 fps on a 60 Hz
+        // display must not slip to every third vblank.
+        gint64 frame_time = gdk_frame_clock_get_frame_time(frame_clock);
+        gint64 refresh_us = 0, presentation_time = 0;
+        gdk_frame_clock_get_refresh_info(frame_clock, frame_time, &refresh_us, &presentation_time);
+        if (refresh_us <= 0) refresh_us = 16667;
+        if (frame_time - self->last_sweep_frame < 1000000 / SWEEP_MAX_FPS - refresh_us / 2) {
+            return G_SOURCE_CONTINUE;
+        }
+        self->last_sweep_frame = frame_time;
+        self->queue_sweep_redraw();
+        return G_SOURCE_CONTINUE;
+    }
+
+    // Invalidate the old and new second hand of every clock
+    void queue_sweep_redraw() {
+        GtkAllocation allocation;
+        gtk_widget_get_allocation(window, &allocation);
+
+        if (drawn_sweep.size() != timezones.size()) {
+            drawn_sweep.assign(timezones.size(), GdkRectangle{0, 0, 0, 0});
+        }
+
+        double now = display_now();
+        for (size_t i = 0; i < timezones.size(); i++) {
+            int x, y, w, h;
+            if (!clock_cell(i, allocation.width, allocation.height, x, y, w, h)) continue;
+
+            struct tm tz_tm;
+            zone_local_time(timezones[i], (time_t)floor(now), &tz_tm);
+            double second_angle = ((tz_tm.tm_sec + (now - floor(now))) * 6 - 90) * M_PI / 180;
+
+            GdkRectangle hand = second_hand_bounds(x, y, w, h, second_angle);
+            GdkRectangle damage = union_rect(drawn_sweep[i], hand);
+            drawn_sweep[i] = hand;
+            gtk_widget_queue_draw_area(window, damage.x, damage.y, damage.width, damage.height);
+        }
+    }
+
+    void on_tick_boundary() {
+        // adjtimex is a cheap syscall; once a minute is plenty
+        time_t now = time(nullptr);
+        if (now - last_sync_check >= 60) {
+            refresh_sync_status();
+        }
+        queue_hands_redraw();
+    }
+
+    void refresh_sync_status() {
+        last_sync_check = time(nullptr);
+        ClockSyncStatus status = time_mgr.checkSystemTimeSync();
+        if (!status.synced && sync_status.synced) {
+            g_print("Warning: System time may not be NTP synchronized (max error %ld ms)\n",
+                    status.max_error_us / 1000);
+        }
+        sync_status = status;
+
+        std::string label = format_sync_status();
+        if (SHOW_SYNC_STATUS && window && label != sync_label) {
+            GtkAllocation allocation;
+            gtk_widget_get_allocation(window, &allocation);
+            gtk_widget_queue_draw_area(window, allocation.width - SYNC_LABEL_WIDTH, 0,
+                                       SYNC_LABEL_WIDTH, SYNC_LABEL_HEIGHT);
+        }
+        sync_label = label;
+    }
+
+    std::string format_sync_status() const {
+        if (!sync_status.synced) return "unsynced";
+
+        char buffer[32];
+        if (sync_status.est_error_us >= 1000) {
+            snprintf(buffer, sizeof(buffer), "±%ldms", sync_status.est_error_us / 1000);
+        } else {
+            snprintf(buffer, sizeof(buffer), "±%ldµs", sync_status.est_error_us);
+        }
+        return buffer;
+    }
+
+    void draw_sync_status(cairo_t *cr, int w) {
+        if (!sync_layout) sync_layout = text_cache.layout(cr, 8, PANGO_WEIGHT_NORMAL);
+        PangoLayout *layout = sync_layout;
+        TextCache::set_text(layout, sync_label);
+
+        int text_w, text_h;
+        pango_layout_get_pixel_size(layout, &text_w, &text_h);
+        if (sync_status.synced) {
+            cairo_set_source_rgba(cr, 0.8, 0.8, 0.8, 0.6);
+        } else {
+            cairo_set_source_rgba(cr, 1.0, 0.6, 0.2, 0.9);
+        }
+        cairo_move_to(cr, w - text_w - 4, 2);
+        pango_cairo_show_layout(cr, layout);
+    }
+
+    // Invalidate only where hands were and will be, or the whole cell when its face flips
+    void queue_hands_redraw() {
+        GtkAllocation allocation;
+        gtk_widget_get_allocation(window, &allocation);
+
+        std::vector<GdkRectangle> damage;
+        compute_damage(allocation.width, allocation.height, display_time(), damage);
+
+        long damaged_pixels = 0;
+        for (const auto& rect : damage) {
+            damaged_pixels += (long)rect.width * rect.height;
+            gtk_widget_queue_draw_area(window, rect.x, rect.y, rect.width, rect.height);
+        }
+
+        if (debug_damage) {
+            debug_tint++;
+            long total = (long)allocation.width * allocation.height;
+            g_print("Damage: %ld px of %ld (%.1f%%)\n", damaged_pixels, total,
+                    total > 0 ? 100.0 * damaged_pixels / total : 0.0);
+        }
+    }
+
+    // Per-clock rectangles that must be repainted to show utc_now
+    void compute_damage(int win_w, int win_h, time_t utc_now, std::vector<GdkRectangle> &out) {
+        if (drawn_hands.size() != timezones.size()) {
+            drawn_hands.assign(timezones.size(), GdkRectangle{0, 0, 0, 0});
+        }
+
+        for (size_t i = 0; i < timezones.size(); i++) {
+            int x, y, w, h;
+            if (!clock_cell(i, win_w, win_h, x, y, w, h)) continue;
+
+            struct tm tz_tm;
+            zone_local_time(timezones[i], utc_now, &tz_tm);
+            bool is_day = (tz_tm.tm_hour >= 6 && tz_tm.tm_hour < 18);
+
+            // While sweeping, the second hand is invalidated by the frame clock instead
+            GdkRectangle hands = hands_bounds(x, y, w, h, tz_tm, SHOW_SECOND_HAND && !sweep_active);
+            GdkRectangle damage = hands;
+
+            const GdkRectangle &old = drawn_hands[i];
+            bool face_stale = i >= faces.size() || !faces[i].labels ||
+                              faces[i].is_day != is_day || faces[i].is_dst != timezones[i].is_dst ||
+                              old.width == 0;
+            if (face_stale) {
+                damage = GdkRectangle{x, y, w, h};
+            } else {
+                damage = union_rect(old, hands);
+            }
+
+            drawn_hands[i] = hands;
+            out.push_back(damage);
+        }
+    }
+
+    // Position of clock i inside a w x h window
+    bool clock_cell(size_t i, int w, int h, int &x, int &y, int &cw, int &ch) const {
+        if (i >= timezones.size()) return false;
+        int columns, rows;
+        grid_size(columns, rows);
+        cw = w / columns;
+        ch = h / rows;
+        x = (int)(i % columns) * cw;
+        y = (int)(i / columns) * ch;
+        return true;
+    }
+
+    static void zone_local_time(const TimeZone &tz, time_t utc_now, struct tm *out) {
+        if (tz.zone) {
+            tz.zone->localTime(utc_now, out);
+        } else {
+            gmtime_r(&utc_now, out);
+        }
+    }
+
+    static void hand_angles(const struct tm &tz_tm, double &hour_angle, double &minute_angle, double &second_angle) {
+        int hours = tz_tm.tm_hour % 12;
+        int minutes = tz_tm.tm_min;
+        int seconds = tz_tm.tm_sec;
+        hour_angle = ((hours + minutes/60.0) * 30 - 90) * M_PI / 180;
+        minute_angle = (minutes * 6 - 90) * M_PI / 180;
+        second_angle = (seconds * 6 - 90) * M_PI / 180;
+    }
+
+    static GdkRectangle union_rect(const GdkRectangle &a, const GdkRectangle &b) {
+        if (a.width == 0 || a.height == 0) return b;
+        int x1 = std::min(a.x, b.x);
+        int y1 = std::min(a.y, b.y);
+        int x2 = std::max(a.x + a.width, b.x + b.width);
+        int y2 = std::max(a.y + a.height, b.y + b.height);
+        return GdkRectangle{x1, y1, x2 - x1, y2 - y1};
+    }
+
+    // Pixel bounds of the hour and minute hands (and optionally the second
+    // hand), their shadows and the center dot
+    static GdkRectangle hands_bounds(int x, int y, int w, int h, const struct tm &tz_tm, bool with_second) {
+        double angles[3];
+        hand_angles(tz_tm, angles[0], angles[1], angles[2]);
+        const double lengths[3] = {0.5, 0.75, 0.85};
+        return bounds_of_hands(x, y, w, h, angles, lengths, with_second ? 3 : 2);
+    }
+
+    static GdkRectangle second_hand_bounds(int x, int y, int w, int h, double second_angle) {
+        const double lengths[1] = {0.85};
+        return bounds_of_hands(x, y, w, h, &second_angle, lengths, 1);
+    }
+
+    static GdkRectangle bounds_of_hands(int x, int y, int w, int h, const double *angles,
+                                        const double *lengths, int hand_count) {
+        int center_x = x + w/2;
+        int center_y = y + (h-60)/2;
+        int radius = std::min(w-15, h-70) / 2;
+        return bounds_around(center_x, center_y, radius, angles, lengths, hand_count);
+    }
+
+    static GdkRectangle bounds_around(int center_x, int center_y, int radius, const double *angles,
+                                      const double *lengths, int hand_count) {
+        double min_x = center_x, max_x = center_x + 0.5;
+        double min_y = center_y, max_y = center_y + 0.5;
+        for (int i = 0; i < hand_count; i++) {
+            double ex = center_x + (radius * lengths[i]) * cos(angles[i]);
+            double ey = center_y + (radius * lengths[i]) * sin(angles[i]);
+            min_x = std::min(min_x, ex);
+            max_x = std::max(max_x, ex + 0.5);
+            min_y = std::min(min_y, ey);
+            max_y = std::max(max_y, ey + 0.5);
+        }
+
+        // Widest stroke is the 4px hour hand shadow with round caps, plus a pixel of antialiasing
+        const double pad = 3.0;
+        int x1 = (int)floor(min_x - pad);
+        int y1 = (int)floor(min_y - pad);
+        int x2 = (int)ceil(max_x + pad);
+        int y2 = (int)ceil(max_y + pad);
+        return GdkRectangle{x1, y1, x2 - x1, y2 - y1};
+    }
+
+    static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+
+        GtkAllocation allocation;
+        gtk_widget_get_allocation(widget, &allocation);
+
+        if (!self->sweep_active) {
+            self->render(cr, allocation.width, allocation.height, self->display_time());
+            return FALSE;
+        }
+
+        gint64 start = g_get_monotonic_time();
+        self->render(cr, allocation.width, allocation.height, self->display_now());
+        double elapsed_ms = (g_get_monotonic_time() - start) / 1000.0;
+
+        // Warm-up frames rebuild caches; judge the steady state only
+        self->sweep_frames++;
+        self->sweep_draw_ms = self->sweep_frames == 1 ? elapsed_ms
+                                                      : 0.9 * self->sweep_draw_ms + 0.1 * elapsed_ms;
+        if (self->sweep_frames > 30 && self->sweep_draw_ms > SWEEP_FRAME_BUDGET_MS) {
+            self->stop_sweep();
+        }
+
+        return FALSE;
+    }
+
+    // Paint the window (or whatever part of it cr is clipped to) for utc_now
+    void render(cairo_t *cr, int w, int h, double utc_now) {
+        cairo_set_antialias(cr, CAIRO_ANTIALIAS_SUBPIXEL);
+
+        cairo_set_source_rgba(cr, BG_RED, BG_GREEN, BG_BLUE, OPACITY);
+        cairo_rectangle(cr, 0, 0, w, h);
+        cairo_fill(cr);
+
+        if (faces.size() != timezones.size()) {
+            faces.resize(timezones.size());
+        }
+
+        double clip_x1, clip_y1, clip_x2, clip_y2;
+        cairo_clip_extents(cr, &clip_x1, &clip_y1, &clip_x2, &clip_y2);
+
+        for (size_t i = 0; i < timezones.size(); i++) {
+            int x, y, clock_width, clock_height;
+            if (!clock_cell(i, w, h, x, y, clock_width, clock_height)) continue;
+
+            // Skip clocks entirely outside the damaged area
+            if (x >= clip_x2 || x + clock_width <= clip_x1 ||
+                y >= clip_y2 || y + clock_height <= clip_y1) {
+                continue;
+            }
+
+            draw_analog_clock(cr, x, y, clock_width, clock_height, timezones[i], faces[i], utc_now);
+        }
+
+        if (SHOW_SYNC_STATUS) {
+            draw_sync_status(cr, w);
+        }
+
+        if (debug_damage) {
+            // Areas left alone keep the previous tick's color
+            static const double tints[3][3] = {{1.0, 0.0, 1.0}, {0.0, 1.0, 1.0}, {1.0, 1.0, 0.0}};
+            const double *tint = tints[debug_tint % 3];
+            cairo_set_source_rgba(cr, tint[0], tint[1], tint[2], 0.35);
+            cairo_rectangle(cr, clip_x1, clip_y1, clip_x2 - clip_x1, clip_y2 - clip_y1);
+            cairo_fill(cr);
+        }
+    }
+
+    void draw_analog_clock(cairo_t *cr, int x, int y, int w, int h, const TimeZone &tz, ClockFace &face, double utc_now) {
+        // Get current time in target timezone from its own transition table
+        struct tm tz_tm;
+        zone_local_time(tz, (time_t)floor(utc_now), &tz_tm);
+
+        int hour24 = tz_tm.tm_hour;
+
+        // Determine if it's day or night
+        bool is_day = (hour24 >= 6 && hour24 < 18);
+
+        const DialFace &dial = dial_for(cr, is_day, tz.is_dst, w, h);
+
+        // Re-render the labels only when one of their inputs flips
+        int relative_offset = tz.relative_hours * 60 + tz.relative_mins;
+        if (!face.labels || face.tz_identifier != tz.tz_identifier ||
+            face.is_dst != tz.is_dst || face.width != w || face.height != h ||
+            face.relative_offset != relative_offset) {
+            if (face.labels) cairo_surface_destroy(face.labels);
+
+            int center_y = (h-60)/2;
+            int radius = std::min(w-15, h-70) / 2;
+            face.labels_y = std::max(0, center_y + radius + 8);
+            face.labels = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA,
+                                                       w, std::max(1, h - face.labels_y));
+            face.tz_identifier = tz.tz_identifier;
+            face.is_dst = tz.is_dst;
+            face.width = w;
+            face.height = h;
+            face.relative_offset = relative_offset;
+
+            cairo_t *labels_cr = cairo_create(face.labels);
+            cairo_set_antialias(labels_cr, CAIRO_ANTIALIAS_SUBPIXEL);
+            cairo_translate(labels_cr, 0, -face.labels_y);
+            draw_clock_labels(labels_cr, w, h, tz, face);
+            cairo_destroy(labels_cr);
+        }
+        face.is_day = is_day;
+
+        cairo_set_source_surface(cr, dial.surface, x, y);
+        cairo_paint(cr);
+        cairo_set_source_surface(cr, face.labels, x, y + face.labels_y);
+        cairo_paint(cr);
+
+        if (sweep_active) {
+            draw_sweep_hands(cr, x, y, w, h, tz_tm, is_day, face, utc_now - floor(utc_now));
+        } else if (hand_sprites) {
+            draw_sprite_hands(cr, x, y, w, h, tz_tm, is_day);
+        } else {
+            draw_clock_hands(cr, x, y, w, h, tz_tm, is_day);
+        }
+    }
+
+    // Sprite mode: three blits from the shared atlas plus the center dot
+    void draw_sprite_hands(cairo_t *cr, int x, int y, int w, int h, const struct tm &tz_tm, bool is_day) {
+        int center_x = x + w/2;
+        int center_y = y + (h-60)/2;
+        int radius = std::min(w-15, h-70) / 2;
 
-        gtk_main();
+        const HandAtlas &atlas = hand_atlas_for(cr, radius, is_day);
+        blit_sprite(cr, atlas, atlas.hour[(tz_tm.tm_hour % 12) * 60 + tz_tm.tm_min], center_x, center_y);
+        blit_sprite(cr, atlas, atlas.minute[tz_tm.tm_min], center_x, center_y);
+        if (SHOW_SECOND_HAND) {
+            blit_sprite(cr, atlas, atlas.second[std::min(tz_tm.tm_sec, 59)], center_x, center_y);
+        }
+        draw_center_dot(cr, center_x, center_y, is_day);
     }
 
-    static gboolean update_time(gpointer data) {
-        auto *self = static_cast<MultiClockWidget*>(data);
-        gtk_widget_queue_draw(self->window);
-        return TRUE;
-    }
-    
-    static gboolean update_timezones(gpointer data) {
-        auto *self = static_cast<MultiClockWidget*>(data);
-        self->updateTimezoneData();
-        return TRUE;
+    static void blit_sprite(cairo_t *cr, const HandAtlas &atlas, const HandAtlas::Sprite &sprite,
+                            int center_x, int center_y) {
+        int dest_x = center_x + sprite.dx;
+        int dest_y = center_y + sprite.dy;
+        cairo_set_source_surface(cr, atlas.surface, dest_x - sprite.atlas_x, dest_y - sprite.atlas_y);
+        cairo_rectangle(cr, dest_x, dest_y, sprite.width, sprite.height);
+        cairo_fill(cr);
     }
 
-    static gboolean on_draw(GtkWidget *widget, cairo_t *cr, gpointer data) {
-        auto *self = static_cast<MultiClockWidget*>(data);
+    // Atlases depend only on radius and day/night, so like dials only a few exist
+    const HandAtlas &hand_atlas_for(cairo_t *cr, int radius, bool is_day) {
+        for (const auto &atlas : hand_atlases) {
+            if (atlas.radius == radius && atlas.is_day == is_day) return atlas;
+        }
 
-        GtkAllocation allocation;
-        gtk_widget_get_allocation(widget, &allocation);
-        int w = allocation.width;
-        int h = allocation.height;
+        HandAtlas atlas;
+        atlas.radius = radius;
+        atlas.is_day = is_day;
 
-        cairo_set_antialias(cr, CAIRO_ANTIALIAS_SUBPIXEL);
+        // Shelf-pack each sprite's tight bounds into rows of a fixed-width atlas
+        const int ATLAS_WIDTH = 1024;
+        int pen_x = 0, pen_y = 0, row_height = 0;
+        auto place = [&](double angle, double length) {
+            GdkRectangle bounds = bounds_around(0, 0, radius, &angle, &length, 1);
+            HandAtlas::Sprite sprite;
+            sprite.dx = bounds.x;
+            sprite.dy = bounds.y;
+            sprite.width = bounds.width;
+            sprite.height = bounds.height;
+            if (pen_x + sprite.width > ATLAS_WIDTH) {
+                pen_x = 0;
+                pen_y += row_height;
+                row_height = 0;
+            }
+            sprite.atlas_x = pen_x;
+            sprite.atlas_y = pen_y;
+            pen_x += sprite.width;
+            row_height = std::max(row_height, sprite.height);
+            return sprite;
+        };
+        for (int i = 0; i < 720; i++) atlas.hour.push_back(place((i * 0.5 - 90) * M_PI / 180, 0.5));
+        for (int i = 0; i < 60; i++) atlas.minute.push_back(place((i * 6 - 90) * M_PI / 180, 0.75));
+        for (int i = 0; i < 60; i++) atlas.second.push_back(place((i * 6 - 90) * M_PI / 180, 0.85));
 
-        cairo_set_source_rgba(cr, BG_RED, BG_GREEN, BG_BLUE, OPACITY);
-        cairo_rectangle(cr, 0, 0, w, h);
-        cairo_fill(cr);
+        atlas.surface = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA,
+                                                     ATLAS_WIDTH, pen_y + row_height);
+        cairo_t *atlas_cr = cairo_create(atlas.surface);
+        cairo_set_antialias(atlas_cr, CAIRO_ANTIALIAS_SUBPIXEL);
+        // Draw each hand around a center placed so its bounds land on the sprite, clipped to it
+        auto render_sprite = [&](const HandAtlas::Sprite &sprite, double angle, int hand) {
+            cairo_save(atlas_cr);
+            cairo_rectangle(atlas_cr, sprite.atlas_x, sprite.atlas_y, sprite.width, sprite.height);
+            cairo_clip(atlas_cr);
+            int center_x = sprite.atlas_x - sprite.dx;
+            int center_y = sprite.atlas_y - sprite.dy;
+            if (hand == 0) {
+                draw_hour_hand(atlas_cr, center_x, center_y, radius, angle, is_day);
+            } else if (hand == 1) {
+                draw_minute_hand(atlas_cr, center_x, center_y, radius, angle, is_day);
+            } else {
+                draw_second_hand(atlas_cr, center_x, center_y, radius, angle);
+            }
+            cairo_restore(atlas_cr);
+        };
+        for (int i = 0; i < 720; i++) render_sprite(atlas.hour[i], (i * 0.5 - 90) * M_PI / 180, 0);
+        for (int i = 0; i < 60; i++) render_sprite(atlas.minute[i], (i * 6 - 90) * M_PI / 180, 1);
+        for (int i = 0; i < 60; i++) render_sprite(atlas.second[i], (i * 6 - 90) * M_PI / 180, 2);
+        cairo_destroy(atlas_cr);
 
-        int clock_width = w / 4;
-        int clock_height = h;
+        hand_atlases.push_back(atlas);
+        return hand_atlases.back();
+    }
+
+    // Sweep mode: blit the cached hour/minute hands, stroke only the second hand
+    void draw_sweep_hands(cairo_t *cr, int x, int y, int w, int h, const struct tm &tz_tm,
+                          bool is_day, ClockFace &face, double second_fraction) {
+        int center_x = x + w/2;
+        int center_y = y + (h-60)/2;
+        int radius = std::min(w-15, h-70) / 2;
+
+        double hour_angle, minute_angle, second_angle;
+        hand_angles(tz_tm, hour_angle, minute_angle, second_angle);
+        second_angle = ((tz_tm.tm_sec + second_fraction) * 6 - 90) * M_PI / 180;
 
-        for (int i = 0; i < 4 && i < self->timezones.size(); i++) {
-            int x = i * clock_width;
-            int y = 0;
+        GdkRectangle rect = hands_bounds(x, y, w, h, tz_tm, false);
+        int minute_of_day = tz_tm.tm_hour * 60 + tz_tm.tm_min;
+        if (!face.hands || face.hands_minute_of_day != minute_of_day || face.hands_is_day != is_day ||
+            face.hands_rect.x != rect.x || face.hands_rect.y != rect.y ||
+            face.hands_rect.width != rect.width || face.hands_rect.height != rect.height) {
+            if (face.hands) cairo_surface_destroy(face.hands);
+            face.hands = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA,
+                                                      rect.width, rect.height);
+            face.hands_rect = rect;
+            face.hands_minute_of_day = minute_of_day;
+            face.hands_is_day = is_day;
 
-            self->draw_analog_clock(cr, x, y, clock_width, clock_height, self->timezones[i]);
+            cairo_t *hands_cr = cairo_create(face.hands);
+            cairo_set_antialias(hands_cr, CAIRO_ANTIALIAS_SUBPIXEL);
+            cairo_translate(hands_cr, -rect.x, -rect.y);
+            draw_hour_minute_hands(hands_cr, center_x, center_y, radius, hour_angle, minute_angle, is_day);
+            cairo_destroy(hands_cr);
         }
 
-        return FALSE;
+        cairo_set_source_surface(cr, face.hands, rect.x, rect.y);
+        cairo_paint(cr);
+
+        draw_second_hand(cr, center_x, center_y, radius, second_angle);
+        draw_center_dot(cr, center_x, center_y, is_day);
     }
 
-    void draw_analog_clock(cairo_t *cr, int x, int y, int w, int h, const TimeZone &tz) {
-        // Get current time in target timezone using system libraries
-        struct tm tz_tm;
-        time_mgr.getTimezoneTime(tz.tz_identifier, &tz_tm);
+    // Dials depend only on day/night, DST and size, so at most a handful exist
+    const DialFace &dial_for(cairo_t *cr, bool is_day, bool is_dst, int w, int h) {
+        for (const auto &dial : dials) {
+            if (dial.is_day == is_day && dial.is_dst == is_dst && dial.width == w && dial.height == h) {
+                return dial;
+            }
+        }
 
-        int hours = tz_tm.tm_hour % 12;
-        int minutes = tz_tm.tm_min;
-        int seconds = tz_tm.tm_sec;
-        int hour24 = tz_tm.tm_hour;
+        DialFace dial;
+        dial.surface = cairo_surface_create_similar(cairo_get_target(cr), CAIRO_CONTENT_COLOR_ALPHA, w, h);
+        dial.is_day = is_day;
+        dial.is_dst = is_dst;
+        dial.width = w;
+        dial.height = h;
 
-        // Determine if it's day or night
-        bool is_day = (hour24 >= 6 && hour24 < 18);
+        cairo_t *dial_cr = cairo_create(dial.surface);
+        cairo_set_antialias(dial_cr, CAIRO_ANTIALIAS_SUBPIXEL);
+        draw_clock_dial(dial_cr, w, h, is_day, is_dst);
+        cairo_destroy(dial_cr);
+
+        dials.push_back(dial);
+        return dials.back();
+    }
 
+    // Face, ring and hour markers
+    void draw_clock_dial(cairo_t *cr, int w, int h, bool is_day, bool is_dst) {
         // Clock center and radius
-        int center_x = x + w/2;
-        int center_y = y + (h-60)/2;
+        int center_x = w/2;
+        int center_y = (h-60)/2;
         int radius = std::min(w-15, h-70) / 2;
 
         // Draw clock face with DST indicator
         if (is_day) {
-            if (tz.is_dst) {
+            if (is_dst) {
                 // Slightly warmer white for DST
                 cairo_set_source_rgba(cr, 1.0, 0.98, 0.94, 0.95);
             } else {
                 cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 0.95);
             }
         } else {
-            if (tz.is_dst) {
+            if (is_dst) {
                 // Slightly lighter dark for DST
                 cairo_set_source_rgba(cr, 0.15, 0.15, 0.15, 0.95);
             } else {
@@ -370,7 +2154,7 @@ public:
         cairo_fill(cr);
 
         // Outer ring with DST color coding
-        if (tz.is_dst) {
+        if (is_dst) {
             cairo_set_source_rgba(cr, 1.0, 0.8, 0.2, 0.4); // Golden ring for DST
         } else {
             cairo_set_source_rgba(cr, is_day ? 0.8 : 0.3, is_day ? 0.8 : 0.3, is_day ? 0.8 : 0.3, 0.6);
@@ -406,82 +2190,28 @@ public:
                 cairo_fill(cr);
             }
         }
+    }
 
-        // Draw hands (same as before)
-        double hand_r = is_day ? 0.1 : 0.95;
-        double hand_g = is_day ? 0.1 : 0.95;
-        double hand_b = is_day ? 0.1 : 0.95;
-
-        // Hour hand
-        double hour_angle = ((hours + minutes/60.0) * 30 - 90) * M_PI / 180;
-        cairo_set_source_rgba(cr, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, 0.3);
-        cairo_set_line_width(cr, 4);
-        cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
-        cairo_move_to(cr, center_x+0.5, center_y+0.5);
-        cairo_line_to(cr, 
-            center_x+0.5 + (radius * 0.5) * cos(hour_angle),
-            center_y+0.5 + (radius * 0.5) * sin(hour_angle));
-        cairo_stroke(cr);
-        
-        cairo_set_source_rgb(cr, hand_r, hand_g, hand_b);
-        cairo_set_line_width(cr, 3);
-        cairo_move_to(cr, center_x, center_y);
-        cairo_line_to(cr, 
-            center_x + (radius * 0.5) * cos(hour_angle),
-            center_y + (radius * 0.5) * sin(hour_angle));
-        cairo_stroke(cr);
-
-        // Minute hand
-        double minute_angle = (minutes * 6 - 90) * M_PI / 180;
-        cairo_set_source_rgba(cr, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, 0.3);
-        cairo_set_line_width(cr, 3);
-        cairo_move_to(cr, center_x+0.5, center_y+0.5);
-        cairo_line_to(cr,
-            center_x+0.5 + (radius * 0.75) * cos(minute_angle),
-            center_y+0.5 + (radius * 0.75) * sin(minute_angle));
-        cairo_stroke(cr);
-        
-        cairo_set_source_rgb(cr, hand_r, hand_g, hand_b);
-        cairo_set_line_width(cr, 2);
-        cairo_move_to(cr, center_x, center_y);
-        cairo_line_to(cr,
-            center_x + (radius * 0.75) * cos(minute_angle),
-            center_y + (radius * 0.75) * sin(minute_angle));
-        cairo_stroke(cr);
-
-        // Second hand
-        double second_angle = (seconds * 6 - 90) * M_PI / 180;
-        cairo_set_source_rgb(cr, 1, 0.2, 0.2);
-        cairo_set_line_width(cr, 1);
-        cairo_move_to(cr, center_x, center_y);
-        cairo_line_to(cr,
-            center_x + (radius * 0.85) * cos(second_angle),
-            center_y + (radius * 0.85) * sin(second_angle));
-        cairo_stroke(cr);
-
-        // Center dot
-        cairo_set_source_rgba(cr, is_day ? 0.2 : 0.8, is_day ? 0.2 : 0.8, is_day ? 0.2 : 0.8, 0.8);
-        cairo_arc(cr, center_x, center_y, 3, 0, 2 * M_PI);
-        cairo_fill(cr);
-        cairo_set_source_rgb(cr, hand_r, hand_g, hand_b);
-        cairo_arc(cr, center_x, center_y, 1.5, 0, 2 * M_PI);
-        cairo_fill(cr);
+    // City, status and relative offset under the dial
+    void draw_clock_labels(cairo_t *cr, int w, int h, const TimeZone &tz, ClockFace &face) {
+        int center_x = w/2;
+        int center_y = (h-60)/2;
+        int radius = std::min(w-15, h-70) / 2;
 
         // Text labels
         int text_start_y = center_y + radius + 10;
 
-        PangoLayout *layout = pango_cairo_create_layout(cr);
-        PangoFontDescription *desc = pango_font_description_new();
-        
-        pango_font_description_set_family(desc, "SF Pro Display");
-        pango_font_description_set_weight(desc, PANGO_WEIGHT_MEDIUM);
-        pango_font_description_set_absolute_size(desc, 11 * PANGO_SCALE);
-        pango_layout_set_font_description(layout, desc);
+        if (!face.city_layout) {
+            face.city_layout = text_cache.layout(cr, 11, PANGO_WEIGHT_MEDIUM);
+            face.status_layout = text_cache.layout(cr, 9, PANGO_WEIGHT_NORMAL);
+            face.offset_layout = text_cache.layout(cr, 9, PANGO_WEIGHT_NORMAL);
+        }
+        PangoLayout *layout = face.city_layout;
         
         // City name with DST indicator
         std::string city_text = tz.name;
         if (tz.is_dst) city_text += " ⚡"; // Lightning bolt for DST
-        pango_layout_set_text(layout, city_text.c_str(), -1);
+        TextCache::set_text(layout, city_text);
         
         int text_w, text_h;
         pango_layout_get_pixel_size(layout, &text_w, &text_h);
@@ -491,10 +2221,8 @@ public:
         pango_cairo_show_layout(cr, layout);
 
         // Status
-        pango_font_description_set_weight(desc, PANGO_WEIGHT_NORMAL);
-        pango_font_description_set_absolute_size(desc, 9 * PANGO_SCALE);
-        pango_layout_set_font_description(layout, desc);
-        pango_layout_set_text(layout, tz.status.c_str(), -1);
+        layout = face.status_layout;
+        TextCache::set_text(layout, tz.status);
         pango_layout_get_pixel_size(layout, &text_w, &text_h);
         
         cairo_set_source_rgba(cr, 0.8, 0.8, 0.8, 0.9);
@@ -525,13 +2253,103 @@ public:
             }
         }
         
-        pango_layout_set_text(layout, offset_str, -1);
+        layout = face.offset_layout;
+        TextCache::set_text(layout, offset_str);
         pango_layout_get_pixel_size(layout, &text_w, &text_h);
         cairo_move_to(cr, center_x - text_w/2, text_start_y + 25);
         pango_cairo_show_layout(cr, layout);
+    }
+
+    void draw_clock_hands(cairo_t *cr, int x, int y, int w, int h, const struct tm &tz_tm, bool is_day) {
+        double hour_angle, minute_angle, second_angle;
+        hand_angles(tz_tm, hour_angle, minute_angle, second_angle);
+
+        // Clock center and radius
+        int center_x = x + w/2;
+        int center_y = y + (h-60)/2;
+        int radius = std::min(w-15, h-70) / 2;
+
+        draw_hour_minute_hands(cr, center_x, center_y, radius, hour_angle, minute_angle, is_day);
+        if (SHOW_SECOND_HAND) {
+            draw_second_hand(cr, center_x, center_y, radius, second_angle);
+        }
+        draw_center_dot(cr, center_x, center_y, is_day);
+    }
+
+    static void draw_hour_minute_hands(cairo_t *cr, int center_x, int center_y, int radius,
+                                       double hour_angle, double minute_angle, bool is_day) {
+        draw_hour_hand(cr, center_x, center_y, radius, hour_angle, is_day);
+        draw_minute_hand(cr, center_x, center_y, radius, minute_angle, is_day);
+    }
+
+    static void draw_hour_hand(cairo_t *cr, int center_x, int center_y, int radius, double hour_angle, bool is_day) {
+        double hand_r = is_day ? 0.1 : 0.95;
+        double hand_g = is_day ? 0.1 : 0.95;
+        double hand_b = is_day ? 0.1 : 0.95;
+
+        cairo_set_source_rgba(cr, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, 0.3);
+        cairo_set_line_width(cr, 4);
+        cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+        cairo_move_to(cr, center_x+0.5, center_y+0.5);
+        cairo_line_to(cr, 
+            center_x+0.5 + (radius * 0.5) * cos(hour_angle),
+            center_y+0.5 + (radius * 0.5) * sin(hour_angle));
+        cairo_stroke(cr);
+        
+        cairo_set_source_rgb(cr, hand_r, hand_g, hand_b);
+        cairo_set_line_width(cr, 3);
+        cairo_move_to(cr, center_x, center_y);
+        cairo_line_to(cr, 
+            center_x + (radius * 0.5) * cos(hour_angle),
+            center_y + (radius * 0.5) * sin(hour_angle));
+        cairo_stroke(cr);
+    }
+
+    static void draw_minute_hand(cairo_t *cr, int center_x, int center_y, int radius, double minute_angle, bool is_day) {
+        double hand_r = is_day ? 0.1 : 0.95;
+        double hand_g = is_day ? 0.1 : 0.95;
+        double hand_b = is_day ? 0.1 : 0.95;
+
+        cairo_set_source_rgba(cr, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, is_day ? 0.0 : 1.0, 0.3);
+        cairo_set_line_width(cr, 3);
+        cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+        cairo_move_to(cr, center_x+0.5, center_y+0.5);
+        cairo_line_to(cr,
+            center_x+0.5 + (radius * 0.75) * cos(minute_angle),
+            center_y+0.5 + (radius * 0.75) * sin(minute_angle));
+        cairo_stroke(cr);
+        
+        cairo_set_source_rgb(cr, hand_r, hand_g, hand_b);
+        cairo_set_line_width(cr, 2);
+        cairo_move_to(cr, center_x, center_y);
+        cairo_line_to(cr,
+            center_x + (radius * 0.75) * cos(minute_angle),
+            center_y + (radius * 0.75) * sin(minute_angle));
+        cairo_stroke(cr);
+    }
+
+    static void draw_second_hand(cairo_t *cr, int center_x, int center_y, int radius, double second_angle) {
+        cairo_set_source_rgb(cr, 1, 0.2, 0.2);
+        cairo_set_line_width(cr, 1);
+        cairo_set_line_cap(cr, CAIRO_LINE_CAP_ROUND);
+        cairo_move_to(cr, center_x, center_y);
+        cairo_line_to(cr,
+            center_x + (radius * 0.85) * cos(second_angle),
+            center_y + (radius * 0.85) * sin(second_angle));
+        cairo_stroke(cr);
+    }
 
-        g_object_unref(layout);
-        pango_font_description_free(desc);
+    static void draw_center_dot(cairo_t *cr, int center_x, int center_y, bool is_day) {
+        double hand_r = is_day ? 0.1 : 0.95;
+        double hand_g = is_day ? 0.1 : 0.95;
+        double hand_b = is_day ? 0.1 : 0.95;
+
+        cairo_set_source_rgba(cr, is_day ? 0.2 : 0.8, is_day ? 0.2 : 0.8, is_day ? 0.2 : 0.8, 0.8);
+        cairo_arc(cr, center_x, center_y, 3, 0, 2 * M_PI);
+        cairo_fill(cr);
+        cairo_set_source_rgb(cr, hand_r, hand_g, hand_b);
+        cairo_arc(cr, center_x, center_y, 1.5, 0, 2 * M_PI);
+        cairo_fill(cr);
     }
 
     static void on_screen_changed(GtkWidget *widget, GdkScreen *old_screen, gpointer user_data) {
@@ -542,18 +2360,321 @@ public:
     }
 
     static gboolean on_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+        auto *self = static_cast<MultiClockWidget*>(user_data);
         if (event->button == 1) {
             gtk_window_begin_move_drag(GTK_WINDOW(widget),
                                        event->button,
                                        (int)event->x_root,
                                        (int)event->y_root,
                                        event->time);
+        } else if (event->button == 3) {
+            self->show_clock_picker();
         }
         return TRUE;
     }
+
+    // ---------------- ADD CLOCK PICKER ----------------
+    void show_clock_picker() {
+        if (picker) {
+            gtk_window_present(GTK_WINDOW(picker));
+            return;
+        }
+        if (!zone_index) zone_index.reset(new ZoneSearchIndex());
+
+        picker = gtk_window_new(GTK_WINDOW_TOPLEVEL);
+        gtk_window_set_decorated(GTK_WINDOW(picker), FALSE);
+        gtk_window_set_transient_for(GTK_WINDOW(picker), GTK_WINDOW(window));
+        gtk_window_set_skip_taskbar_hint(GTK_WINDOW(picker), TRUE);
+        gtk_window_set_skip_pager_hint(GTK_WINDOW(picker), TRUE);
+        gtk_widget_set_size_request(picker, PICKER_WIDTH, -1);
+
+        GtkWidget *box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
+        gtk_container_add(GTK_CONTAINER(picker), box);
+
+        picker_css = gtk_css_provider_new();
+        GtkCssProvider *provider = picker_css;
+        gtk_css_provider_load_from_data(provider,
+            "window, box, list, row { "
+            "  background-color: rgba(40, 40, 45, 0.95); "
+            "  color: #f0f0f0; "
+            "} "
+            "box { "
+            "  padding: 12px; "
+            "} "
+            "entry { "
+            "  background-color: rgba(55, 55, 60, 0.8); "
+            "  border: 1px solid rgba(70, 70, 75, 0.6); "
+            "  border-radius: 8px; "
+            "  padding: 8px 12px; "
+            "  color: #f0f0f0; "
+            "  font-size: 14px; "
+            "} "
+            "row { "
+            "  padding: 4px 8px; "
+            "  border-radius: 6px; "
+            "} "
+            "row:selected { "
+            "  background-color: rgba(255, 149, 0, 0.8); "
+            "}", -1, NULL);
+        for (GtkWidget *styled : {picker, box}) {
+            gtk_style_context_add_provider(gtk_widget_get_style_context(styled),
+                                           GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
+        }
+
+        picker_entry = gtk_entry_new();
+        gtk_entry_set_placeholder_text(GTK_ENTRY(picker_entry), "Add clock: city, country or zone...");
+        gtk_style_context_add_provider(gtk_widget_get_style_context(picker_entry),
+                                       GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
+        gtk_box_pack_start(GTK_BOX(box), picker_entry, FALSE, FALSE, 0);
+
+        picker_list = gtk_list_box_new();
+        gtk_list_box_set_selection_mode(GTK_LIST_BOX(picker_list), GTK_SELECTION_BROWSE);
+        gtk_style_context_add_provider(gtk_widget_get_style_context(picker_list),
+                                       GTK_STYLE_PROVIDER(provider), GTK_STYLE_PROVIDER_PRIORITY_USER);
+        gtk_box_pack_start(GTK_BOX(box), picker_list, FALSE, FALSE, 0);
+
+        g_signal_connect(picker_entry, "changed", G_CALLBACK(on_picker_changed), this);
+        g_signal_connect(picker_entry, "activate", G_CALLBACK(on_picker_activate), this);
+        g_signal_connect(picker_list, "row-activated", G_CALLBACK(on_picker_row_activated), this);
+        g_signal_connect(picker, "key-press-event", G_CALLBACK(on_picker_key), this);
+        g_signal_connect(picker, "destroy", G_CALLBACK(on_picker_destroy), this);
+
+        // Open just below the clocks, right-aligned with them
+        int win_x, win_y, win_w, win_h;
+        gtk_window_get_position(GTK_WINDOW(window), &win_x, &win_y);
+        gtk_window_get_size(GTK_WINDOW(window), &win_w, &win_h);
+        gtk_window_move(GTK_WINDOW(picker), win_x + win_w - PICKER_WIDTH, win_y + win_h + 8);
+
+        gtk_widget_show_all(picker);
+        gtk_widget_grab_focus(picker_entry);
+    }
+
+    // Re-rank on every keystroke and rebuild the result rows
+    void update_picker_results() {
+        auto matches = zone_index->search(gtk_entry_get_text(GTK_ENTRY(picker_entry)), PICKER_RESULTS);
+
+        GList *rows = gtk_container_get_children(GTK_CONTAINER(picker_list));
+        for (GList *row = rows; row; row = row->next) gtk_widget_destroy(GTK_WIDGET(row->data));
+        g_list_free(rows);
+
+        picker_results.clear();
+        for (const auto &match : matches) {
+            const auto *entry = match.entry;
+            std::string detail = entry->country.empty() ? entry->tz_identifier : entry->country;
+            if (!entry->comment.empty()) detail += " - " + entry->comment;
+
+            gchar *markup = g_markup_printf_escaped("<b>%s</b>  <small>%s</small>",
+                                                    entry->city.c_str(), detail.c_str());
+            GtkWidget *label = gtk_label_new(nullptr);
+            gtk_label_set_markup(GTK_LABEL(label), markup);
+            gtk_label_set_ellipsize(GTK_LABEL(label), PANGO_ELLIPSIZE_END);
+            gtk_widget_set_halign(label, GTK_ALIGN_START);
+            g_free(markup);
+
+            gtk_list_box_insert(GTK_LIST_BOX(picker_list), label, -1);
+            GtkWidget *row = gtk_widget_get_parent(label);
+            gtk_style_context_add_provider(gtk_widget_get_style_context(row),
+                                           GTK_STYLE_PROVIDER(picker_css), GTK_STYLE_PROVIDER_PRIORITY_USER);
+            picker_results.push_back(entry);
+        }
+
+        GtkListBoxRow *first = gtk_list_box_get_row_at_index(GTK_LIST_BOX(picker_list), 0);
+        if (first) gtk_list_box_select_row(GTK_LIST_BOX(picker_list), first);
+        gtk_widget_show_all(picker_list);
+    }
+
+    void add_clock(const ZoneSearchIndex::Entry &entry) {
+        add_timezone({entry.city, "Today", entry.tz_identifier});
+        updateTimezoneData();
+
+        // Grow the grid and keep it anchored to the top-right corner
+        int width, height;
+        window_size(width, height);
+        gtk_widget_set_size_request(window, width, height);
+        gtk_window_resize(GTK_WINDOW(window), width, height);
+        gtk_window_move(GTK_WINDOW(window), SCREEN_WIDTH - width - RIGHT_MARGIN, TOP_MARGIN);
+        drawn_hands.clear();
+        gtk_widget_queue_draw(window);
+    }
+
+    void close_clock_picker() {
+        if (picker) gtk_widget_destroy(picker);
+    }
+
+    static void on_picker_changed(GtkEditable *editable, gpointer data) {
+        static_cast<MultiClockWidget*>(data)->update_picker_results();
+    }
+
+    static void on_picker_activate(GtkEntry *entry, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        GtkListBoxRow *row = gtk_list_box_get_selected_row(GTK_LIST_BOX(self->picker_list));
+        if (row) on_picker_row_activated(GTK_LIST_BOX(self->picker_list), row, data);
+    }
+
+    static void on_picker_row_activated(GtkListBox *list, GtkListBoxRow *row, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        int index = gtk_list_box_row_get_index(row);
+        if (index < 0 || index >= (int)self->picker_results.size()) return;
+        self->add_clock(*self->picker_results[index]);
+        self->close_clock_picker();
+    }
+
+    // Escape closes; Up/Down move the selection without leaving the entry
+    static gboolean on_picker_key(GtkWidget *widget, GdkEventKey *event, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        if (event->keyval == GDK_KEY_Escape) {
+            self->close_clock_picker();
+            return TRUE;
+        }
+        if (event->keyval == GDK_KEY_Down || event->keyval == GDK_KEY_Up) {
+            GtkListBox *list = GTK_LIST_BOX(self->picker_list);
+            GtkListBoxRow *row = gtk_list_box_get_selected_row(list);
+            int index = row ? gtk_list_box_row_get_index(row) : -1;
+            index += event->keyval == GDK_KEY_Down ? 1 : -1;
+            GtkListBoxRow *next = gtk_list_box_get_row_at_index(list, std::max(0, index));
+            if (next) gtk_list_box_select_row(list, next);
+            return TRUE;
+        }
+        return FALSE;
+    }
+
+    static void on_picker_destroy(GtkWidget *widget, gpointer data) {
+        auto *self = static_cast<MultiClockWidget*>(data);
+        self->picker = nullptr;
+        self->picker_entry = nullptr;
+        self->picker_list = nullptr;
+        self->picker_results.clear();
+        if (self->picker_css) g_object_unref(self->picker_css);
+        self->picker_css = nullptr;
+    }
 };
 
+#ifdef GWS_BENCH
+#include "gws_bench.h"
+#include <sys/wait.h>
+
+// Every zone in zone1970.tab, used to fill large benchmark grids
+static std::vector<TimezoneConfig> bench_zone_configs(int count) {
+    std::vector<TimezoneConfig> all(std::begin(TIMEZONE_CONFIGS), std::end(TIMEZONE_CONFIGS));
+    std::ifstream tab("/usr/share/zoneinfo/zone1970.tab");
+    std::string line;
+    while (std::getline(tab, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        std::string codes, coords, tz;
+        std::getline(fields, codes, '\t');
+        std::getline(fields, coords, '\t');
+        std::getline(fields, tz, '\t');
+
+        std::string city = tz.substr(tz.rfind('/') + 1);
+        std::replace(city.begin(), city.end(), '_', ' ');
+        all.push_back({city, "Today", tz});
+    }
+
+    std::vector<TimezoneConfig> configs;
+    for (int i = 0; i < count; i++) configs.push_back(all[i % all.size()]);
+    return configs;
+}
+
+static void run_clock_bench(int count, int iterations, bool sprites) {
+    long rss_before = bench_status_kb("VmRSS:");
+
+    MultiClockWidget clock(bench_zone_configs(count));
+    clock.set_hand_sprites(sprites);
+    int w, h;
+    clock.window_size(w, h);
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+
+    time_t t = time(nullptr);
+    BenchFrames cold, full, tick;
+
+    // First frame builds every dial, label surface and zone table
+    cairo_t *cr = cairo_create(surface);
+    cold.run([&] { clock.render(cr, w, h, t); });
+    cairo_destroy(cr);
+
+    std::vector<GdkRectangle> damage;
+    clock.compute_damage(w, h, t, damage);
+
+    for (int i = 0; i < iterations; i++) {
+        t++;
+
+        // Per-second tick: only the damaged hand regions
+        damage.clear();
+        clock.compute_damage(w, h, t, damage);
+        cr = cairo_create(surface);
+        for (const auto& rect : damage) {
+            cairo_rectangle(cr, rect.x, rect.y, rect.width, rect.height);
+        }
+        cairo_clip(cr);
+        tick.run([&] { clock.render(cr, w, h, t); });
+        cairo_destroy(cr);
+
+        // Full-window redraw with warm caches (expose, compositor reset)
+        cr = cairo_create(surface);
+        full.run([&] { clock.render(cr, w, h, t); });
+        cairo_destroy(cr);
+    }
+
+    printf("%d clocks (%dx%d), %s hands:\n", count, w, h, sprites ? "sprite" : "stroked");
+    cold.print("first frame");
+    full.print("full redraw");
+    tick.print("tick (damage only)");
+    printf("  RSS %ld kB (+%ld kB for the widget), peak %ld kB\n",
+           bench_status_kb("VmRSS:"), bench_status_kb("VmRSS:") - rss_before, bench_status_kb("VmHWM:"));
+
+    cairo_surface_destroy(surface);
+}
+
+// Zone picker: lazy index build, then one search per keystroke typing every city name
+static void run_search_bench() {
+    ZoneSearchIndex index;
+    BenchStats build, keystroke;
+
+    double start = bench_now_ms();
+    size_t zones = index.size();
+    build.add(bench_now_ms() - start);
+
+    for (const auto &config : bench_zone_configs(zones)) {
+        for (size_t len = 1; len <= config.name.size(); len++) {
+            start = bench_now_ms();
+            index.search(config.name.substr(0, len), 8);
+            keystroke.add(bench_now_ms() - start);
+        }
+    }
+
+    printf("zone search over %zu zones:\n", zones);
+    build.print("index build");
+    keystroke.print("keystroke");
+}
+
+// Offscreen redraw benchmark: clock_bench [iterations] [clock counts...]
+int main(int argc, char** argv) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 300;
+    std::vector<int> counts;
+    for (int i = 2; i < argc; i++) counts.push_back(atoi(argv[i]));
+    if (counts.empty()) counts = {4, 32, 256};
+
+    run_search_bench();
+
+    // One child per grid size and hand mode so each RSS figure starts from a clean process
+    for (int count : counts) {
+        for (bool sprites : {false, true}) {
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid == 0) {
+                run_clock_bench(count, iterations, sprites);
+                fflush(stdout);
+                _exit(0);
+            }
+            waitpid(pid, nullptr, 0);
+        }
+    }
+    return 0;
+}
+#else
 int main(int argc, char** argv) {
     MultiClockWidget clock;
     return 0;
 }
+#endif
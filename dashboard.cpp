@@ -50,6 +50,9 @@ struct TodoItem {
 };
 
 class CombinedDashboardWidget {
+#ifdef GWS_BENCH
+    friend void run_dashboard_bench(int iterations);
+#endif
 private:
     GtkWidget *window;
     GtkWidget *overlay;
@@ -326,9 +329,13 @@ public:
 
         GtkAllocation allocation;
         gtk_widget_get_allocation(widget, &allocation);
-        int w = allocation.width;
-        int h = allocation.height;
+        self->render(cr, allocation.width, allocation.height);
 
+        return FALSE;
+    }
+
+    // Paint both cards into a w x h area; also used by the offscreen benchmark
+    void render(cairo_t *cr, int w, int h) {
         cairo_set_antialias(cr, CAIRO_ANTIALIAS_SUBPIXEL);
 
         // Dark background
@@ -339,14 +346,12 @@ public:
         int y_offset = 0;
         
         // Draw calendar card
-        self->drawCalendarCard(cr, 0, y_offset, w, self->calendar_height);
-        y_offset += self->calendar_height + WIDGET_SPACING;
+        drawCalendarCard(cr, 0, y_offset, w, calendar_height);
+        y_offset += calendar_height + WIDGET_SPACING;
         
         // Draw todo card
-        int todo_height = self->base_todo_height + std::max(0, std::min(8, (int)self->todos.size())) * self->item_height;
-        self->drawTodoCard(cr, 0, y_offset, w, todo_height);
-
-        return FALSE;
+        int todo_height = base_todo_height + std::max(0, std::min(8, (int)todos.size())) * item_height;
+        drawTodoCard(cr, 0, y_offset, w, todo_height);
     }
     
     void drawCalendarCard(cairo_t *cr, int x, int y, int w, int h) {
@@ -1124,8 +1129,63 @@ public:
     }
 };
 
+#ifdef GWS_BENCH
+#include "gws_bench.h"
+
+// Offscreen redraw of both cards with a fixed month of notes and a full todo list
+void run_dashboard_bench(int iterations) {
+    CombinedDashboardWidget dashboard;
+    dashboard.notes.clear();
+    dashboard.todos.clear();
+    for (int day = 1; day <= 28; day += 3) {
+        char date[16];
+        snprintf(date, sizeof(date), "%04d-%02d-%02d",
+                 dashboard.display_date.tm_year + 1900, dashboard.display_date.tm_mon + 1, day);
+        dashboard.notes.push_back({date, "Benchmark note", day % 2 == 0});
+    }
+    for (int i = 0; i < 8; i++) {
+        dashboard.todos.push_back({"Benchmark task " + std::to_string(i + 1), i % 3 == 0, i % 2 ? "09:30" : ""});
+    }
+    int todo_height = dashboard.base_todo_height + 8 * dashboard.item_height;
+    int w = dashboard.total_width;
+    int h = dashboard.calendar_height + todo_height + 2 * WIDGET_SPACING;
+
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, w, h);
+    BenchFrames cold, frames, hover;
+
+    cairo_t *cr = cairo_create(surface);
+    cold.run([&] { dashboard.render(cr, w, h); });
+    for (int i = 0; i < iterations; i++) {
+        // Plain redraw, as on the 1 s timer
+        dashboard.hover_day = -1;
+        dashboard.hover_todo_item = -1;
+        frames.run([&] { dashboard.render(cr, w, h); });
+
+        // Pointer moving over the calendar and the list
+        dashboard.hover_day = 1 + i % 28;
+        dashboard.hover_todo_item = i % 8;
+        hover.run([&] { dashboard.render(cr, w, h); });
+    }
+    cairo_destroy(cr);
+
+    printf("dashboard (%dx%d):\n", w, h);
+    cold.print("first frame");
+    frames.print("redraw");
+    hover.print("redraw with hover");
+    bench_print_memory();
+
+    cairo_surface_destroy(surface);
+}
+
+// Offscreen redraw benchmark: dashboard_bench [iterations]
+int main(int argc, char** argv) {
+    run_dashboard_bench(argc > 1 ? atoi(argv[1]) : 300);
+    return 0;
+}
+#else
 int main(int argc, char** argv) {
     CombinedDashboardWidget dashboard;
     dashboard.run();
     return 0;
 }
+#endif
@@ -0,0 +1,151 @@
+// Helpers shared by the -DGWS_BENCH builds of the widgets: frame timing
+// percentiles, allocation counts and resident memory, all measured offscreen.
+// Include from exactly one translation unit: it replaces malloc and friends.
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// ---------------- ALLOCATION COUNTER ----------------
+// Every malloc-family call in the process goes through these wrappers, so
+// cairo, pango, glib and operator new are all counted, not just our code.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+}
+
+static std::atomic<unsigned long> bench_alloc_count{0};
+
+extern "C" void *malloc(size_t size) {
+    bench_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+    bench_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size) {
+    bench_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+extern "C" void *memalign(size_t alignment, size_t size) {
+    bench_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __libc_memalign(alignment, size);
+}
+
+// memalign rounds a bad alignment up; POSIX wants it refused
+extern "C" int posix_memalign(void **out, size_t alignment, size_t size) {
+    if (alignment == 0 || alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void *ptr = memalign(alignment, size);
+    if (!ptr) return ENOMEM;
+    *out = ptr;
+    return 0;
+}
+
+extern "C" void *aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+// Allocations so far; diff around a frame for allocations per frame
+inline unsigned long bench_allocs() {
+    return bench_alloc_count.load(std::memory_order_relaxed);
+}
+
+inline double bench_now_ms() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+// CPU time used by the whole process (all threads), in ms
+inline double bench_cpu_ms() {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+// Reads a "VmRSS:" / "VmHWM:" style field from /proc/self/status, in kB
+inline long bench_status_kb(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    size_t len = std::char_traits<char>::length(field);
+    while (std::getline(status, line)) {
+        if (line.compare(0, len, field) == 0) {
+            return std::stol(line.substr(len));
+        }
+    }
+    return -1;
+}
+
+// Proportional set size of a process, in kB: pages shared by N processes
+// count 1/N each, so summing over processes gives their real total
+inline long bench_pss_kb(long pid) {
+    std::ifstream rollup("/proc/" + std::to_string(pid) + "/smaps_rollup");
+    std::string line;
+    while (std::getline(rollup, line)) {
+        if (line.compare(0, 4, "Pss:") == 0) return std::stol(line.substr(4));
+    }
+    return -1;
+}
+
+class BenchStats {
+public:
+    void add(double ms) { samples.push_back(ms); }
+
+    double percentile(double p) const {
+        if (samples.empty()) return 0.0;
+        std::vector<double> sorted = samples;
+        std::sort(sorted.begin(), sorted.end());
+        size_t idx = std::min(sorted.size() - 1, (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5));
+        return sorted[idx];
+    }
+
+    void print(const char* label, const char* unit = "ms") const {
+        printf("  %-22s n=%-6zu p50=%8.3f  p90=%8.3f  p99=%8.3f  max=%8.3f %s\n",
+               label, samples.size(), percentile(50), percentile(90), percentile(99), percentile(100), unit);
+    }
+
+private:
+    std::vector<double> samples;
+};
+
+// Times one frame and counts the allocations it made
+class BenchFrames {
+public:
+    template <typename Draw>
+    void run(Draw draw) {
+        unsigned long allocs_before = bench_allocs();
+        double start = bench_now_ms();
+        draw();
+        double elapsed = bench_now_ms() - start;
+        unsigned long allocated = bench_allocs() - allocs_before;
+        time.add(elapsed);
+        allocs.add((double)allocated);
+    }
+
+    void print(const char* label) const {
+        time.print(label);
+        allocs.print("  allocations", "/frame");
+    }
+
+private:
+    BenchStats time;
+    BenchStats allocs;
+};
+
+// Peak and current resident memory, printed after a widget's frames
+inline void bench_print_memory() {
+    printf("  RSS %ld kB, peak %ld kB\n", bench_status_kb("VmRSS:"), bench_status_kb("VmHWM:"));
+}
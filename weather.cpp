@@ -111,9 +111,13 @@ public:
 };
 
 class WeatherWidget {
+#ifdef GWS_BENCH
+    friend void run_weather_bench(int iterations);
+#endif
 private:
     GtkWidget *window;
     GtkWidget *overlay;
+    GtkIconTheme *icon_theme = nullptr;
     WeatherData weather;
     LocationData location;
     bool data_loaded = false;
@@ -196,7 +200,6 @@ private:
     }
     
     void drawSystemWeatherIcon(cairo_t *cr, int x, int y, int size) {
-        GtkIconTheme *icon_theme = gtk_icon_theme_get_default();
         std::string icon_name = getGnomeWeatherIcon();
         
         GdkPixbuf *pixbuf = gtk_icon_theme_load_icon(icon_theme, icon_name.c_str(), size, GTK_ICON_LOOKUP_USE_BUILTIN, nullptr);
@@ -455,6 +458,7 @@ public:
     
     void run() {
         gtk_init(nullptr, nullptr);
+        icon_theme = gtk_icon_theme_get_default();
 
         window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
         gtk_window_set_decorated(GTK_WINDOW(window), FALSE);
@@ -504,8 +508,13 @@ public:
 
         GtkAllocation allocation;
         gtk_widget_get_allocation(widget, &allocation);
-        int size = std::min(allocation.width, allocation.height);
+        self->render(cr, std::min(allocation.width, allocation.height));
 
+        return FALSE;
+    }
+
+    // Paint the card into a size x size area; also used by the offscreen benchmark
+    void render(cairo_t *cr, int size) {
         // Clear background
         cairo_set_operator(cr, CAIRO_OPERATOR_CLEAR);
         cairo_paint(cr);
@@ -514,7 +523,7 @@ public:
         cairo_set_antialias(cr, CAIRO_ANTIALIAS_SUBPIXEL);
 
         // Background with clean solid color (no gradient to avoid artifacts)
-        self->drawRoundedRect(cr, 0, 0, size, size, CARD_RADIUS);
+        drawRoundedRect(cr, 0, 0, size, size, CARD_RADIUS);
         cairo_set_source_rgba(cr, 0.08, 0.08, 0.09, 0.96);
         cairo_fill_preserve(cr);
 
@@ -523,7 +532,7 @@ public:
         cairo_set_line_width(cr, 0.5);
         cairo_stroke(cr);
 
-        if (!self->data_loaded) {
+        if (!data_loaded) {
             PangoLayout *layout = pango_cairo_create_layout(cr);
             PangoFontDescription *desc = pango_font_description_new();
             pango_font_description_set_family(desc, "SF Pro Display");
@@ -542,11 +551,11 @@ public:
 
             g_object_unref(layout);
             pango_font_description_free(desc);
-            return FALSE;
+            return;
         }
 
         // Left side - Weather icon and main info
-        self->drawWeatherIcon(cr, 16, 16, 40);
+        drawWeatherIcon(cr, 16, 16, 40);
 
         PangoLayout *layout = pango_cairo_create_layout(cr);
         PangoFontDescription *desc = pango_font_description_new();
@@ -557,7 +566,7 @@ public:
         pango_font_description_set_absolute_size(desc, 10 * PANGO_SCALE);
         pango_layout_set_font_description(layout, desc);
 
-        pango_layout_set_text(layout, self->weather.location.c_str(), -1);
+        pango_layout_set_text(layout, weather.location.c_str(), -1);
         cairo_set_source_rgba(cr, 0.9, 0.9, 0.9, 0.9);
         cairo_move_to(cr, 16, 62);
         pango_cairo_show_layout(cr, layout);
@@ -568,7 +577,7 @@ public:
         pango_layout_set_font_description(layout, desc);
         
         char temp_str[16];
-        snprintf(temp_str, sizeof(temp_str), "%.1f°", self->weather.temp_c);
+        snprintf(temp_str, sizeof(temp_str), "%.1f°", weather.temp_c);
         pango_layout_set_text(layout, temp_str, -1);
         cairo_set_source_rgba(cr, 1.0, 1.0, 1.0, 1.0);
         cairo_move_to(cr, 16, 80);
@@ -579,7 +588,7 @@ public:
         pango_font_description_set_absolute_size(desc, 10 * PANGO_SCALE);
         pango_layout_set_font_description(layout, desc);
         
-        pango_layout_set_text(layout, self->weather.condition.c_str(), -1);
+        pango_layout_set_text(layout, weather.condition.c_str(), -1);
         cairo_set_source_rgba(cr, 0.85, 0.85, 0.85, 0.8);
         cairo_move_to(cr, 16, 115);
         pango_cairo_show_layout(cr, layout);
@@ -595,61 +604,59 @@ public:
         
         // Right column - better formatted with proper decimals
         char feels_str[20];
-        snprintf(feels_str, sizeof(feels_str), "Feels like  %.1f°", self->weather.feels_like);
+        snprintf(feels_str, sizeof(feels_str), "Feels like  %.1f°", weather.feels_like);
         pango_layout_set_text(layout, feels_str, -1);
         cairo_move_to(cr, right_x, y_start);
         pango_cairo_show_layout(cr, layout);
 
         char humidity_str[20];
-        snprintf(humidity_str, sizeof(humidity_str), "Humidity  %d%%", self->weather.humidity);
+        snprintf(humidity_str, sizeof(humidity_str), "Humidity  %d%%", weather.humidity);
         pango_layout_set_text(layout, humidity_str, -1);
         cairo_move_to(cr, right_x, y_start + line_height);
         pango_cairo_show_layout(cr, layout);
 
         char wind_str[20];
-        snprintf(wind_str, sizeof(wind_str), "Wind  %.1f km/h", self->weather.wind_speed);
+        snprintf(wind_str, sizeof(wind_str), "Wind  %.1f km/h", weather.wind_speed);
         pango_layout_set_text(layout, wind_str, -1);
         cairo_move_to(cr, right_x, y_start + 2 * line_height);
         pango_cairo_show_layout(cr, layout);
 
         char pressure_str[20];
-        snprintf(pressure_str, sizeof(pressure_str), "Pressure  %.1f kPa", self->weather.pressure * 0.1);
+        snprintf(pressure_str, sizeof(pressure_str), "Pressure  %.1f kPa", weather.pressure * 0.1);
         pango_layout_set_text(layout, pressure_str, -1);
         cairo_move_to(cr, right_x, y_start + 3 * line_height);
         pango_cairo_show_layout(cr, layout);
 
         char uv_str[20];
-        snprintf(uv_str, sizeof(uv_str), "UV Index  %.1f", self->weather.uv_index);
+        snprintf(uv_str, sizeof(uv_str), "UV Index  %.1f", weather.uv_index);
         pango_layout_set_text(layout, uv_str, -1);
         cairo_move_to(cr, right_x, y_start + 4 * line_height);
         pango_cairo_show_layout(cr, layout);
 
         char vis_str[20];
-        snprintf(vis_str, sizeof(vis_str), "Visibility  %d km", self->weather.visibility);
+        snprintf(vis_str, sizeof(vis_str), "Visibility  %d km", weather.visibility);
         pango_layout_set_text(layout, vis_str, -1);
         cairo_move_to(cr, right_x, y_start + 5 * line_height);
         pango_cairo_show_layout(cr, layout);
 
         // Sunrise/Sunset - bottom right
         char sunrise_str[20];
-        snprintf(sunrise_str, sizeof(sunrise_str), "Sunrise  %s", self->weather.sunrise.c_str());
+        snprintf(sunrise_str, sizeof(sunrise_str), "Sunrise  %s", weather.sunrise.c_str());
         pango_layout_set_text(layout, sunrise_str, -1);
         cairo_move_to(cr, right_x, y_start + 6 * line_height + 8);
         pango_cairo_show_layout(cr, layout);
 
         char sunset_str[20];
-        snprintf(sunset_str, sizeof(sunset_str), "Sunset  %s", self->weather.sunset.c_str());
+        snprintf(sunset_str, sizeof(sunset_str), "Sunset  %s", weather.sunset.c_str());
         pango_layout_set_text(layout, sunset_str, -1);
         cairo_move_to(cr, right_x, y_start + 7 * line_height + 8);
         pango_cairo_show_layout(cr, layout);
 
         // Draw refresh button (small clock on bottom left)
-        self->drawRefreshButton(cr, 12, size - 28);
+        drawRefreshButton(cr, 12, size - 28);
 
         g_object_unref(layout);
         pango_font_description_free(desc);
-
-        return FALSE;
     }
 
     static gboolean on_button_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
@@ -693,8 +700,63 @@ public:
     }
 };
 
+#ifdef GWS_BENCH
+#include "gws_bench.h"
+
+// Offscreen redraw of the card with fixed readings; no network, no display
+void run_weather_bench(int iterations) {
+    WeatherWidget widget;
+    widget.icon_theme = gtk_icon_theme_new();  // No screen, so no default theme
+
+    BenchFrames loading, day, night;
+    cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, WIDGET_SIZE, WIDGET_SIZE);
+    cairo_t *cr = cairo_create(surface);
+
+    for (int i = 0; i < iterations; i++) {
+        loading.run([&] { widget.render(cr, WIDGET_SIZE); });
+    }
+
+    widget.weather.condition = "Partly cloudy";
+    widget.weather.location = "Singapore";
+    widget.weather.temp_c = 29.4;
+    widget.weather.feels_like = 33.1;
+    widget.weather.humidity = 79;
+    widget.weather.wind_speed = 12.6;
+    widget.weather.wind_dir = "SSE";
+    widget.weather.pressure = 1009;
+    widget.weather.uv_index = 7;
+    widget.weather.visibility = 10;
+    widget.weather.sunrise = "07:02";
+    widget.weather.sunset = "19:11";
+    widget.data_loaded = true;
+
+    for (int i = 0; i < iterations; i++) {
+        widget.weather.is_day = true;
+        day.run([&] { widget.render(cr, WIDGET_SIZE); });
+        widget.weather.is_day = false;
+        night.run([&] { widget.render(cr, WIDGET_SIZE); });
+    }
+    cairo_destroy(cr);
+
+    printf("weather (%dx%d):\n", WIDGET_SIZE, WIDGET_SIZE);
+    loading.print("loading card");
+    day.print("day card");
+    night.print("night card");
+    bench_print_memory();
+
+    cairo_surface_destroy(surface);
+    g_object_unref(widget.icon_theme);
+}
+
+// Offscreen redraw benchmark: weather_bench [iterations]
+int main(int argc, char** argv) {
+    run_weather_bench(argc > 1 ? atoi(argv[1]) : 300);
+    return 0;
+}
+#else
 int main(int argc, char** argv) {
     WeatherWidget widget;
     widget.run();
     return 0;
 }
+#endif